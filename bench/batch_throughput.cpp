@@ -0,0 +1,56 @@
+#include <chrono>
+#include <cstdlib>
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+/* Measures the throughput of lexer_t::tokenize_batch,
+ * first with a single thread and then with every thread count
+ * up to the one given as the first argument
+ * (std::thread::hardware_concurrency() by default).
+ *
+ * ./bench/batch-throughput [threads] [inputs]
+ */
+
+int main(int argc, char **argv) {
+  using avt = glex::argument_t::value_t::type_t;
+  using lexer_t = glex::lexer_t<std::vector>;
+
+  std::size_t nthreads = argc > 1 ? std::atoi(argv[1])
+                                  : std::thread::hardware_concurrency();
+  std::size_t ninputs = argc > 2 ? std::atoi(argv[2]) : 200000;
+
+  lexer_t lex{};
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "extr", .verbose = "extract", .concise = 'e', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+
+  const std::vector<lexer_t::input_t> samples = {
+      {"--help", "-ep/path/to/prof", "-f=f1,f2,f3", "--", "--val"},
+      {"--files", "a,b,c,d,e,f", "-hf", "c", "free", "other"},
+      {"--profile=/a/long/path/to/a/profile", "-he", "-p", "y", "--extract"},
+  };
+  std::vector<lexer_t::input_t> inputs{};
+  for (std::size_t i = 0; i < ninputs; ++i)
+    inputs.push_back(samples[i % samples.size()]);
+
+  double base = 0;
+  for (std::size_t t = 1; t <= std::max<std::size_t>(nthreads, 1); ++t) {
+    auto start = std::chrono::steady_clock::now();
+    auto out = lex.tokenize_batch(inputs, t);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    auto rate = out.size() / elapsed.count();
+    if (t == 1)
+      base = rate;
+    std::cout << t << " thread(s): " << static_cast<std::size_t>(rate)
+              << " inputs/s, speedup " << rate / base << std::endl;
+  }
+}
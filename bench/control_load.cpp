@@ -0,0 +1,160 @@
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <gnu-lexer/control_socket.hpp>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+/* Measures a control_server_t serving a lexer, as a node controller
+ * would: every client connection keeps depth frames in flight,
+ * sending a new one for every reply, for the given number of seconds.
+ * It reports the requests per second, and the percentiles of the time
+ * from sending a frame to reading its reply.
+ *
+ * ./bench/control-load [connections] [depth] [seconds]
+ */
+
+namespace {
+using steady = std::chrono::steady_clock;
+
+bool read_all(int fd, char *p, std::size_t n) {
+  while (n) {
+    auto r = ::read(fd, p, n);
+    if (r <= 0)
+      return false;
+    p += r;
+    n -= std::size_t(r);
+  }
+  return true;
+}
+
+bool write_all(int fd, std::string_view data) {
+  while (!data.empty()) {
+    auto n = ::write(fd, data.data(), data.size());
+    if (n <= 0)
+      return false;
+    data.remove_prefix(std::size_t(n));
+  }
+  return true;
+}
+
+struct client_result_t {
+  std::uint64_t requests{0};
+  glex::latency_histogram_t latency{};
+};
+
+void client(const std::string &path, std::size_t depth,
+            steady::time_point end, const std::vector<std::string> &frames,
+            client_result_t &out) {
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))) {
+    std::cerr << "Cannot connect to " << path << std::endl;
+    ::close(fd);
+    return;
+  }
+
+  std::deque<steady::time_point> sent{};
+  std::size_t next = 0;
+  const auto send = [&] {
+    sent.push_back(steady::now());
+    return write_all(fd, frames[next++ % frames.size()]);
+  };
+  for (std::size_t i = 0; i < depth; ++i)
+    if (!send())
+      break;
+
+  std::string reply{};
+  while (!sent.empty()) {
+    unsigned char size[4];
+    if (!read_all(fd, reinterpret_cast<char *>(size), 4))
+      break;
+    reply.resize(size[0] | size[1] << 8 | size[2] << 16 | size[3] << 24);
+    if (!read_all(fd, reply.data(), reply.size()))
+      break;
+    auto now = steady::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  now - sent.front())
+                  .count();
+    ++out.latency.counts[glex::latency_histogram_t::bucket(ns)];
+    ++out.requests;
+    sent.pop_front();
+    if (now < end && !send())
+      break;
+  }
+  ::close(fd);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  using avt = glex::argument_t::value_t::type_t;
+  using lexer_t = glex::lexer_t<std::vector, glex::token_view_t>;
+
+  std::size_t nconnections = argc > 1 ? std::atoi(argv[1]) : 4;
+  std::size_t depth = argc > 2 ? std::atoi(argv[2]) : 16;
+  double seconds = argc > 3 ? std::atof(argv[3]) : 3;
+
+  lexer_t lex{};
+  lex.add({.token = "start", .verbose = "start", .concise = 's', .value = {}});
+  lex.add({.token = "stop", .verbose = "stop", .concise = 'k', .value = {}});
+  lex.add({.token = "nodes",
+           .verbose = "list",
+           .concise = 'l',
+           .value = {.type = avt::multi, .delimiter = ','}});
+  lex.add({.token = "timeout",
+           .verbose = "timeout",
+           .concise = 't',
+           .value = {.type = avt::single,
+                     .element = glex::argument_t::value_t::element_t::uint64}});
+
+  std::vector<std::string> frames(3);
+  glex::append_frame(frames[0], std::vector<std::string_view>{
+                                    "nodectrl", "-s", "--list", "n1,n2,n3"});
+  glex::append_frame(frames[1],
+                     std::vector<std::string_view>{"nodectrl", "--stop",
+                                                   "-l=n4", "--timeout=30"});
+  glex::append_frame(frames[2],
+                     std::vector<std::string_view>{"nodectrl", "-x"});
+
+  // The reply is the number of tokens, or the error code.
+  auto path = "/tmp/glex-control-load-" + std::to_string(::getpid());
+  auto server = glex::serve(lex, path,
+                            [](auto, const auto &status, const auto &tokens,
+                               std::string &reply) {
+                              reply = status ? std::to_string(tokens.size())
+                                             : "error";
+                            });
+  std::thread serving{[&] { server.run(); }};
+
+  auto start = steady::now();
+  auto end = start + std::chrono::duration_cast<steady::duration>(
+                         std::chrono::duration<double>(seconds));
+  std::vector<client_result_t> results(nconnections);
+  std::vector<std::thread> clients{};
+  for (std::size_t i = 0; i < nconnections; ++i)
+    clients.emplace_back(client, std::cref(path), depth, end,
+                         std::cref(frames), std::ref(results[i]));
+  for (auto &c : clients)
+    c.join();
+  std::chrono::duration<double> elapsed = steady::now() - start;
+  server.stop();
+  serving.join();
+
+  client_result_t total{};
+  for (const auto &r : results) {
+    total.requests += r.requests;
+    for (std::size_t b = 0; b < r.latency.counts.size(); ++b)
+      total.latency.counts[b] += r.latency.counts[b];
+  }
+  std::cout << nconnections << " connection(s), depth " << depth << ": "
+            << static_cast<std::size_t>(total.requests / elapsed.count())
+            << " requests/s" << std::endl;
+  for (double p : {0.5, 0.9, 0.99, 0.999})
+    std::cout << "  p" << p * 100 << ": " << total.latency.percentile(p)
+              << " ns" << std::endl;
+}
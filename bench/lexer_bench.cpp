@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <gnu-lexer/lexer.hpp>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+
+/* Measures the tokenize() hot paths over a grid of:
+ * - schema sizes, from 10 to 10000 arguments,
+ * - input styles: bundled short flags (-abcd), long options with =value,
+ *   multi value lists and a mix of the three,
+ * - input lengths (number of chunks),
+ * - owning (token_t) and viewing (token_view_t) tokens, owning
+ *   tokens reused by tokenize_into(), and viewing tokens whose
+ *   values are only split once read (lazy_token_view_t), unread here.
+ *
+ * For every case it reports the throughput, the per call latency
+ * percentiles and the heap allocations per call.
+ *
+ * ./bench/lexer-bench [calls per case]
+ */
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+} // namespace
+
+void *operator new(std::size_t n) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc{};
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using input_t = std::vector<std::string>;
+
+enum class style_t { shortflags, longvalue, multivalue, mixed };
+
+const char *name(style_t s) {
+  switch (s) {
+  case style_t::shortflags:
+    return "short";
+  case style_t::longvalue:
+    return "long=v";
+  case style_t::multivalue:
+    return "multi";
+  case style_t::mixed:
+    return "mixed";
+  }
+  return "";
+}
+
+/* Argument i is a flag, a single value or a multi value argument
+ * depending on i % 3. Only flags get a concise name, one per letter.
+ */
+std::vector<glex::argument_t> schema(std::size_t size) {
+  static constexpr std::string_view letters =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  std::vector<glex::argument_t> args{};
+  for (std::size_t i = 0; i < size; ++i) {
+    auto type = i % 3 == 0 ? avt::none : i % 3 == 1 ? avt::single : avt::multi;
+    auto concise = type == avt::none && i / 3 < letters.size()
+                       ? letters[i / 3]
+                       : char{0};
+    args.push_back({.token = "token" + std::to_string(i),
+                    .verbose = "option" + std::to_string(i),
+                    .concise = concise,
+                    .value = {.type = type, .delimiter = ','}});
+  }
+  return args;
+}
+
+input_t make_input(const std::vector<glex::argument_t> &args, style_t style,
+                   std::size_t length, std::mt19937 &rng) {
+  std::vector<const glex::argument_t *> flags{}, singles{}, multis{};
+  for (const auto &a : args) {
+    if (a.concise)
+      flags.push_back(&a);
+    else if (a.value.type == avt::single)
+      singles.push_back(&a);
+    else if (a.value.type == avt::multi)
+      multis.push_back(&a);
+  }
+  auto pick = [&](const auto &v) { return v[rng() % v.size()]; };
+
+  input_t in{};
+  for (std::size_t i = 0; in.size() < length; ++i) {
+    auto s = style == style_t::mixed ? static_cast<style_t>(i % 3) : style;
+    switch (s) {
+    case style_t::shortflags: {
+      std::string chunk = "-";
+      for (int k = 0; k < 4; ++k)
+        chunk += pick(flags)->concise;
+      in.push_back(chunk);
+      break;
+    }
+    case style_t::longvalue:
+      in.push_back("--" + pick(singles)->verbose + "=/some/path/value");
+      break;
+    case style_t::multivalue:
+      in.push_back("--" + pick(multis)->verbose);
+      in.push_back("first,second,third,fourth");
+      break;
+    case style_t::mixed:
+      break;
+    }
+  }
+  in.resize(length);
+  // A trailing multi option would be missing its value.
+  if (in.back().starts_with("--") && in.back().find('=') == std::string::npos)
+    in.back() = "free-value";
+  return in;
+}
+
+template <typename Token, bool Into = false>
+void run(const std::vector<glex::argument_t> &args, style_t style,
+         std::size_t length, std::size_t calls) {
+  glex::lexer_t<std::vector, Token> lex{};
+  for (const auto &a : args)
+    lex.add(a);
+
+  std::mt19937 rng{42};
+  std::vector<input_t> inputs{};
+  for (int i = 0; i < 64; ++i)
+    inputs.push_back(make_input(args, style, length, rng));
+
+  typename decltype(lex)::container_t out{};
+  const auto call = [&](const input_t &in) {
+    if constexpr (Into)
+      lex.tokenize_into(out, in);
+    else
+      out = lex.tokenize(in);
+  };
+
+  for (std::size_t i = 0; i < calls / 10; ++i) // warm up
+    call(inputs[i % inputs.size()]);
+
+  std::vector<std::chrono::nanoseconds> latency(calls);
+  allocations = 0;
+  auto begin = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < calls; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    call(inputs[i % inputs.size()]);
+    latency[i] = std::chrono::steady_clock::now() - start;
+  }
+  std::chrono::duration<double> total =
+      std::chrono::steady_clock::now() - begin;
+  auto allocs = allocations.load();
+
+  std::sort(latency.begin(), latency.end());
+  auto pct = [&](double p) {
+    return latency[static_cast<std::size_t>(p * (calls - 1))].count();
+  };
+  std::cout << std::setw(6) << args.size() << std::setw(8) << name(style)
+            << std::setw(6) << length << std::setw(6)
+            << (Into ? "into"
+                : std::same_as<Token, glex::token_t>           ? "own"
+                : std::same_as<Token, glex::lazy_token_view_t> ? "lazy"
+                                                               : "view")
+            << std::setw(12) << static_cast<std::size_t>(calls / total.count())
+            << std::setw(10) << pct(0.5) << std::setw(10) << pct(0.9)
+            << std::setw(10) << pct(0.99) << std::setw(10) << std::fixed
+            << std::setprecision(1) << double(allocs) / calls << std::endl;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::size_t calls = argc > 1 ? std::atoi(argv[1]) : 20000;
+  if (!calls)
+    calls = 1;
+
+  std::cout << std::setw(6) << "schema" << std::setw(8) << "style"
+            << std::setw(6) << "argc" << std::setw(6) << "token"
+            << std::setw(12) << "calls/s" << std::setw(10) << "p50 ns"
+            << std::setw(10) << "p90 ns" << std::setw(10) << "p99 ns"
+            << std::setw(10) << "allocs" << std::endl;
+
+  for (std::size_t size : {10, 100, 1000, 10000}) {
+    auto args = schema(size);
+    for (auto style : {style_t::shortflags, style_t::longvalue,
+                       style_t::multivalue, style_t::mixed})
+      for (std::size_t length : {4, 16, 64}) {
+        run<glex::token_t>(args, style, length, calls);
+        run<glex::token_view_t>(args, style, length, calls);
+        run<glex::token_t, true>(args, style, length, calls);
+        run<glex::lazy_token_view_t>(args, style, length, calls);
+      }
+  }
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <gnu-lexer/packed_database.hpp>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/* Compares a database_t to the packed_database_t built from it,
+ * over schemas of 1000 to 20000 arguments like the generated ones:
+ * - hit: looking up long names in the schema,
+ * - miss: looking up long names not in the schema,
+ * - tokenize: tokenize() of 64 long options with token_view_t,
+ * reporting nanoseconds per lookup and per tokenize() call,
+ * and the startup cost of populating the database_t with add()
+ * against mapping a saved image with packed_database_t::load().
+ *
+ * ./bench/packed-bench [rounds]
+ */
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+
+template <typename F> double measure(std::size_t count, F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  std::size_t sink = f();
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  if (!sink)
+    std::cerr << "Nothing found" << std::endl;
+  return elapsed.count() / count;
+}
+
+template <typename Database>
+void run(const char *name, const Database &db,
+         const std::vector<std::string> &hits,
+         const std::vector<std::string> &misses,
+         const std::vector<std::string> &input, std::size_t rounds) {
+  auto hit = measure(rounds * hits.size(), [&] {
+    std::size_t sum = 0;
+    for (std::size_t r = 0; r < rounds; ++r)
+      for (const auto &h : hits)
+        sum += db.verbose(h);
+    return sum;
+  });
+  auto miss = measure(rounds * misses.size(), [&] {
+    std::size_t sum = 1;
+    for (std::size_t r = 0; r < rounds; ++r)
+      for (const auto &m : misses)
+        sum += db.verbose(m);
+    return sum;
+  });
+
+  glex::lexer_t<std::vector, glex::token_view_t, Database> lex{db};
+  auto tok = measure(rounds, [&] {
+    std::size_t sum = 0;
+    for (std::size_t r = 0; r < rounds; ++r)
+      sum += lex.tokenize(input).size();
+    return sum;
+  });
+
+  std::cout << std::setw(8) << db.size() << std::setw(10) << name
+            << std::fixed << std::setprecision(1) << std::setw(10) << hit
+            << std::setw(10) << miss << std::setw(12) << tok << std::endl;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::size_t rounds = argc > 1 ? std::atoi(argv[1]) : 200;
+  if (!rounds)
+    rounds = 1;
+
+  std::cout << std::setw(8) << "schema" << std::setw(10) << "database"
+            << std::setw(10) << "hit ns" << std::setw(10) << "miss ns"
+            << std::setw(12) << "tokenize ns" << std::endl;
+
+  std::mt19937 rng{42};
+  for (std::size_t size : {1000, 2000, 5000, 20000}) {
+    std::vector<glex::argument_t> args{};
+    for (std::size_t i = 0; i < size; ++i)
+      args.push_back({.token = "token" + std::to_string(i),
+                      .verbose = "generated-option-" + std::to_string(i),
+                      .concise = 0,
+                      .value = {.type = i % 2 ? avt::single : avt::none}});
+
+    glex::database_t db{};
+    auto add = measure(1000, [&] {
+      for (const auto &a : args)
+        db.add(a);
+      return db.size();
+    });
+    const std::string image = "packed-bench.glex";
+    glex::packed_database_t{db}.save(image);
+    auto load = measure(1000, [&] {
+      return glex::packed_database_t::load(image).size();
+    });
+    std::remove(image.c_str());
+
+    std::vector<std::string> hits{}, misses{}, input{};
+    for (std::size_t i = 0; i < 1024; ++i) {
+      auto n = rng() % size;
+      hits.push_back("generated-option-" + std::to_string(n));
+      misses.push_back("generated-option-" + std::to_string(size + n));
+    }
+    for (std::size_t i = 0; i < 64; ++i) {
+      auto n = rng() % size;
+      input.push_back("--generated-option-" + std::to_string(n) +
+                      (n % 2 ? "=value" : ""));
+    }
+
+    run("database", db, hits, misses, input, rounds);
+    run("packed", glex::packed_database_t{db}, hits, misses, input, rounds);
+    std::cout << "startup: add() " << add << " us, load() " << load << " us"
+              << std::endl;
+  }
+}
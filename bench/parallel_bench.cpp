@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstdlib>
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+/* Measures lexer_t::tokenize_parallel on a single input of millions
+ * of chunks, such as an expanded glob, against tokenize(),
+ * for every thread count up to the one given as the first argument
+ * (std::thread::hardware_concurrency() by default).
+ *
+ * ./bench/parallel-bench [threads] [chunks]
+ */
+
+int main(int argc, char **argv) {
+  using avt = glex::argument_t::value_t::type_t;
+  using lexer_t = glex::lexer_t<std::vector>;
+
+  std::size_t nthreads = argc > 1 ? std::atoi(argv[1])
+                                  : std::thread::hardware_concurrency();
+  std::size_t nchunks = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+  lexer_t lex{};
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "extr", .verbose = "extract", .concise = 'e', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+
+  const std::vector<std::string> samples = {
+      "--files", "src/a.cpp,src/b.cpp", "-he", "-p", "/path/to/profile",
+      "src/some/dir/file.cpp", "--extract", "other/file.hpp"};
+  lexer_t::input_t in{};
+  for (std::size_t i = 0; i < nchunks; ++i)
+    in.push_back(samples[i % samples.size()]);
+
+  const auto time = [&](auto &&f) {
+    auto start = std::chrono::steady_clock::now();
+    auto out = f();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return std::pair{out.size(), elapsed.count()};
+  };
+
+  auto [ntokens, base] = time([&] { return lex.tokenize(in); });
+  std::cout << "tokenize: " << static_cast<std::size_t>(nchunks / base)
+            << " chunks/s, " << ntokens << " tokens" << std::endl;
+  for (std::size_t t = 1; t <= std::max<std::size_t>(nthreads, 1); ++t) {
+    auto [n, elapsed] =
+        time([&] { return lex.tokenize_parallel(in, 0, t); });
+    std::cout << t << " thread(s): "
+              << static_cast<std::size_t>(nchunks / elapsed)
+              << " chunks/s, speedup " << base / elapsed
+              << (n == ntokens ? "" : " (token count mismatch)") << std::endl;
+  }
+}
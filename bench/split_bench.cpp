@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdlib>
+#include <gnu-lexer/split.hpp>
+#include <iostream>
+#include <ranges>
+#include <string>
+#include <vector>
+
+/* Compares ways of splitting a multi value, such as a --list
+ * of tens of thousands of comma separated node ids:
+ * - ranges: the views::split | views::transform pipeline,
+ * - find: a std::string_view::find loop,
+ * - split: glex::detail::split,
+ * each producing std::string values, and for the last two
+ * also std::string_view values to show the cost of the scan alone.
+ *
+ * ./bench/split-bench [values] [rounds]
+ */
+
+namespace {
+template <typename F> double measure(std::size_t rounds, F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  std::size_t sink = 0;
+  for (std::size_t r = 0; r < rounds; ++r)
+    sink += f();
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  if (!sink)
+    std::cerr << "No values" << std::endl;
+  return elapsed.count() / rounds;
+}
+
+template <typename S> std::vector<S> by_ranges(std::string_view val, char d) {
+  std::vector<S> out{};
+  for (const auto &part : val | std::views::split(d) |
+                              std::views::transform([](const auto &p) {
+                                return S{p.begin(), p.end()};
+                              }))
+    out.push_back(part);
+  return out;
+}
+
+template <typename S> std::vector<S> by_find(std::string_view val, char d) {
+  std::vector<S> out{};
+  for (std::string_view::size_type pos = 0;;) {
+    auto end = val.find(d, pos);
+    out.emplace_back(val.substr(pos, end - pos));
+    if (end == std::string_view::npos)
+      break;
+    pos = end + 1;
+  }
+  return out;
+}
+
+template <typename S> std::vector<S> by_split(std::string_view val, char d) {
+  std::vector<S> out{};
+  glex::detail::split(val, d, [&](std::string_view p) { out.emplace_back(p); });
+  return out;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::size_t nvalues = argc > 1 ? std::atoi(argv[1]) : 50000;
+  std::size_t rounds = argc > 2 ? std::atoi(argv[2]) : 200;
+  if (!rounds)
+    rounds = 1;
+
+  std::string val{};
+  for (std::size_t i = 0; i < nvalues; ++i)
+    val += "node" + std::to_string(i * 7919 % 100000) + ",";
+
+  std::cout << nvalues << " values, " << val.size() << " bytes, us per split"
+            << std::endl;
+  auto report = [&](const char *name, auto &&f) {
+    std::cout << name << measure(rounds, [&] { return f(val, ',').size(); })
+              << std::endl;
+  };
+  report("ranges string: ", by_ranges<std::string>);
+  report("find string:   ", by_find<std::string>);
+  report("split string:  ", by_split<std::string>);
+  report("find view:     ", by_find<std::string_view>);
+  report("split view:    ", by_split<std::string_view>);
+}
@@ -0,0 +1,20 @@
+# glex_schema(<output> <definitions>)
+#
+# Packs the argument definitions into the packed_database_t image
+# <output> at build time, with the glex-schema tool.
+# Relative paths are relative to the current source
+# and binary directories. Add the output to a target's sources,
+# or to a custom target, for the image to be generated.
+function(glex_schema output definitions)
+  get_filename_component(output "${output}" ABSOLUTE
+    BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+  get_filename_component(definitions "${definitions}" ABSOLUTE
+    BASE_DIR "${CMAKE_CURRENT_SOURCE_DIR}")
+  add_custom_command(
+    OUTPUT "${output}"
+    COMMAND glex-schema "${definitions}" "${output}"
+    DEPENDS glex-schema "${definitions}"
+    COMMENT "Packing the argument schema ${output}"
+    VERBATIM
+  )
+endfunction()
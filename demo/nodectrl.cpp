@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <gnu-lexer/lexer.hpp>
 
 /* In this example we create a lexer for a
@@ -19,31 +20,70 @@
  * ./demo/nodectrl -sl 1,2
  * ./demo/nodectrl -sl=1,2
  * ./demo/nodectrl --start --list=1,2
+ *
+ * It also completes its own arguments for the shell:
+ * ./demo/nodectrl --complete <index> <words...>
+ * prints the candidates for the word at index, one per line.
+ * With bash:
+ *
+ * _nodectrl() {
+ *   COMPREPLY=($(./demo/nodectrl --complete "$COMP_CWORD" "${COMP_WORDS[@]}"))
+ * }
+ * complete -F _nodectrl ./demo/nodectrl
  */
 
-void parse(const std::list<glex::token_t>&);
+/* The tokens carry the ids of their arguments,
+ * which add() returns, so the parser compares integers
+ * rather than names.
+ */
+struct arg_ids_t {
+  glex::arg_id_t nodes;
+  glex::arg_id_t start;
+};
+
+void parse(const std::list<glex::token_id_t>&, const arg_ids_t&);
 
 int main(int argc, char** argv) {
   using av_t = glex::argument_t::value_t::type_t;
-  using tokenizer_t = glex::lexer_t<std::list>;
+  using tokenizer_t = glex::lexer_t<std::list, glex::token_id_t>;
   try {
     tokenizer_t lex{};
     // lex.debug(true); // Enable this for debug prints
 
     /* First, we are going to create the argument database. */
-    lex.add({.token = "nodes",
+    /* The node ids are decoded while tokenizing,
+     * so the parser gets numbers rather than strings.
+     */
+    arg_ids_t ids{};
+    ids.nodes = lex.add({.token = "nodes",
         .verbose = "list",
         .concise = 'l',
-        .value = {.type = av_t::multi, .delimiter = ','}
+        .value = {.type = av_t::multi, .delimiter = ',',
+                  .element = glex::argument_t::value_t::element_t::uint64}
     });
-    lex.add({.token = "start",
+    /* The lexer checks that the action is given, once,
+     * and not without a list of nodes.
+     */
+    ids.start = lex.add({.token = "start",
         .verbose = "start",
         .concise = 's',
-        .value = {.type = av_t::none, .delimiter = 0}
+        .value = {.type = av_t::none, .delimiter = 0},
+        .constraints = {.required = true, .max = 1, .depends = ids.nodes}
     });
 
+    /* The words of a completion request start with the program name,
+     * which the lexer skips as it does for argv.
+     */
+    if (argc > 2 && std::string_view{argv[1]} == "--complete") {
+      auto words = glex::read(argv, argc - 3, 3);
+      auto completion = lex.complete(words, std::atoi(argv[2]), 1);
+      for (const auto& c : completion.candidates)
+        std::cout << c << '\n';
+      return 0;
+    }
+
     /* Next, we are going to process the supplied input. */
-    parse(lex.tokenize(argc, argv));
+    parse(lex.tokenize(argc, argv), ids);
   }
   catch (const std::exception& e) {
     std::cerr << "ERR: " << e.what() << std::endl;
@@ -52,36 +92,36 @@ int main(int argc, char** argv) {
 }
 
 template <typename T>
-void parse_start(T& t) {
-  if (!t.size() || t.front().id != "nodes")
+void parse_start(T& t, const arg_ids_t& ids) {
+  if (!t.size() || t.front().id != ids.nodes)
     throw std::runtime_error{"The start action requires a list of nodes."};
+  const auto& nodes = t.front().scalars;
   std::cout << "starting nodes ";
-  for (std::size_t i = 0; i < t.front().values.size(); ++i) {
-    std::cout << t.front().values[i];
-    if (i != t.front().values.size() -1)
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    std::cout << std::get<std::uint64_t>(nodes[i]);
+    if (i != nodes.size() -1)
       std::cout << ", ";
   }
   std::cout << std::endl;
   t.pop_front();
 }
 
-void parse(const std::list<glex::token_t>& toks) {
-  static std::unordered_map<std::string, std::vector<std::string>> actions = {
-    {"start", {"nodes"}}
-  };
-
-  std::list<glex::token_t> tokens{toks.begin(), toks.end()};
+void parse(const std::list<glex::token_id_t>& toks, const arg_ids_t& ids) {
+  std::list<glex::token_id_t> tokens{toks.begin(), toks.end()};
   if (!tokens.size())
     throw std::runtime_error{"No tokens"};
 
   try {
     while (tokens.size()) {
-      if (tokens.front().id == "start") {
+      auto id = tokens.front().id;
+      if (id == ids.start) {
         tokens.pop_front();
-        parse_start(tokens);
-      }
-      if (tokens.front().id.empty())
+        parse_start(tokens, ids);
+      } else if (id == glex::no_arg) {
         throw std::runtime_error{"Free values are not allowed."};
+      } else {
+        throw std::runtime_error{"A list of nodes requires an action."};
+      }
     }
   } catch (const std::exception& e) {
     throw std::runtime_error{std::string{"Parsing failed: "} + e.what()};
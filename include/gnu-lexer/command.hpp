@@ -0,0 +1,182 @@
+#pragma once
+#include <expected>
+#include <functional>
+#include <gnu-lexer/lexer.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace glex {
+/* A command line with subcommands, e.g. nodectrl --verbose start -l1,2,
+ * where each command has arguments of its own. A command tokenizes its
+ * arguments with its lexer() up to the first free value, which names
+ * one of its subcommands, and the subcommand tokenizes the rest of the
+ * input the same way. A command without subcommands tokenizes all of
+ * the rest, free values included.
+ *
+ * A subcommand is built by the function given to subcommand() the first
+ * time it is selected, so a program only pays for the arguments
+ * of the commands it runs. Building is done once, even under many
+ * threads, and is tried again if the function throws.
+ * Subcommands must not be added while tokenizing.
+ */
+template <template <typename, typename...> typename ContainerType,
+          typename Token = token_t>
+class command_t {
+public:
+  using lexer_type = lexer_t<ContainerType, Token>;
+  using container_t = typename lexer_type::container_t;
+  using input_t = typename lexer_type::input_t;
+  using offset_t = typename lexer_type::offset_t;
+  using builder_t = std::function<void(command_t &)>;
+
+  // The tokens of a command on the path, with the name it was selected by.
+  struct level_t {
+    std::string name; // empty for the top-level command
+    container_t tokens;
+  };
+  // The top-level command first.
+  using result_t = std::expected<std::vector<level_t>, lex_error>;
+
+  lexer_type &lexer() { return lex_; }
+  const lexer_type &lexer() const { return lex_; }
+
+  void subcommand(std::string name, builder_t build) {
+    auto child = std::make_unique<child_t>();
+    child->build = std::move(build);
+    children_.insert_or_assign(std::move(name), std::move(child));
+  }
+  bool has_subcommands() const { return !children_.empty(); }
+
+  // The subcommand, built if it was not yet, or nullptr if unknown.
+  const command_t *subcommand(std::string_view name) const {
+    auto it = children_.find(name);
+    if (it == children_.end())
+      return nullptr;
+    auto &child = *it->second;
+    std::call_once(child.once, [&] {
+      auto cmd = std::make_unique<command_t>();
+      child.build(*cmd);
+      child.command = std::move(cmd);
+    });
+    return child.command.get();
+  }
+
+  std::vector<level_t> tokenize(int argc, char **argv, int skip = 1) const {
+    const lexer_type *last = &lex_;
+    auto r = try_tokenize(argc, argv, skip, last);
+    if (!r) {
+      auto i = r.error().index;
+      throw std::runtime_error{last->message(
+          r.error(), i < std::size_t(argc) ? std::string_view{argv[i]}
+                                           : std::string_view{})};
+    }
+    return std::move(*r);
+  }
+
+  std::vector<level_t> tokenize(const input_t &in,
+                                const offset_t &off = 0) const {
+    const lexer_type *last = &lex_;
+    auto r = try_tokenize(in, off, last);
+    if (!r) {
+      auto i = r.error().index;
+      throw std::runtime_error{last->message(
+          r.error(),
+          i < in.size() ? std::string_view{in[i]} : std::string_view{})};
+    }
+    return std::move(*r);
+  }
+
+  // Tokens viewing a temporary input would dangle.
+  std::vector<level_t> tokenize(const input_t &&,
+                                const offset_t & = 0) const
+    requires std::same_as<typename Token::string_type, std::string_view>
+  = delete;
+
+  result_t try_tokenize(int argc, char **argv, int skip = 1) const {
+    const lexer_type *last = nullptr;
+    return try_tokenize(argc, argv, skip, last);
+  }
+
+  result_t try_tokenize(const input_t &in, const offset_t &off = 0) const {
+    const lexer_type *last = nullptr;
+    return try_tokenize(in, off, last);
+  }
+
+  result_t try_tokenize(const input_t &&, const offset_t & = 0) const
+    requires std::same_as<typename Token::string_type, std::string_view>
+  = delete;
+
+private:
+  struct child_t {
+    builder_t build;
+    std::once_flag once;
+    std::unique_ptr<command_t> command;
+  };
+
+  // last is set to the lexer of the last command on the path.
+  result_t try_tokenize(int argc, char **argv, int skip,
+                        const lexer_type *&last) const {
+    return walk(
+        std::size_t(argc), skip, last,
+        [&](const lexer_type &lex, offset_t &off) {
+          return lex.try_tokenize_head(argc, argv, off);
+        },
+        [&](const lexer_type &lex, offset_t off) {
+          return lex.try_tokenize(argc, argv, int(off));
+        },
+        [&](std::size_t i) { return std::string_view{argv[i]}; });
+  }
+
+  result_t try_tokenize(const input_t &in, offset_t off,
+                        const lexer_type *&last) const {
+    return walk(
+        in.size(), off, last,
+        [&](const lexer_type &lex, offset_t &o) {
+          return lex.try_tokenize_head(in, o);
+        },
+        [&](const lexer_type &lex, offset_t o) {
+          return lex.try_tokenize(in, o);
+        },
+        [&](std::size_t i) { return std::string_view{in[i]}; });
+  }
+
+  template <typename Head, typename Rest, typename Chunk>
+  result_t walk(std::size_t n, offset_t off, const lexer_type *&last,
+                Head &&head, Rest &&rest, Chunk &&chunk) const {
+    std::vector<level_t> out{};
+    const command_t *cmd = this;
+    std::string name{};
+    // Every command but the last stops at the name of the next one.
+    for (; cmd->has_subcommands(); ++off) {
+      last = &cmd->lex_;
+      auto r = head(cmd->lex_, off);
+      if (!r)
+        return std::unexpected{r.error()};
+      out.push_back({std::move(name), std::move(*r)});
+      if (off >= n)
+        return out;
+      name = chunk(off);
+      cmd = cmd->subcommand(name);
+      if (!cmd)
+        return std::unexpected{lex_error{
+            .code = lex_error::code_t::unknown_command, .index = off,
+            .offset = 0}};
+    }
+    last = &cmd->lex_;
+    auto r = rest(cmd->lex_, off);
+    if (!r)
+      return std::unexpected{r.error()};
+    out.push_back({std::move(name), std::move(*r)});
+    return out;
+  }
+
+  lexer_type lex_{};
+  std::unordered_map<std::string, std::unique_ptr<child_t>, string_hash,
+                     std::equal_to<>>
+      children_{};
+};
+} // namespace glex
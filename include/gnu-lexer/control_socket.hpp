@@ -0,0 +1,128 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <gnu-lexer/lexer.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace glex {
+/* Appends the frame of argv to out, as a client of a control_server_t
+ * sends it: the size of the payload as 4 little-endian bytes,
+ * then every element of argv followed by a NUL.
+ * A reply frame has the same size prefix, followed by the reply.
+ */
+void append_frame(std::string &out, std::span<const std::string_view> argv);
+
+/* Reads the frames sent to a UNIX domain socket at path, and answers
+ * every one of them with a reply frame, in order, e.g. the commands
+ * of a node controller. A single thread waits on all the connections
+ * with epoll, reads whatever they sent into a buffer kept for each,
+ * calls the handler for every complete frame in it, and writes the
+ * replies of a read together. A client may send frames without
+ * waiting for the replies, which then pipelines its reads with
+ * the handling of the frames already read.
+ *
+ * The handler gets argc and an argv pointing into the buffer, with
+ * the NULs of the frame as terminators and argv[argc] null, so that
+ * a lexer_t can tokenize it in place. They are only valid during
+ * the call. A connection sending a frame larger than max_frame,
+ * or not ending in a NUL, is closed.
+ * A connection with replies waiting to be written is not read
+ * until they are, so a client that does not read is not buffered for.
+ * A client closing before reading its replies only closes its
+ * connection, the server does not get a SIGPIPE for it.
+ */
+class control_server_t {
+public:
+  using handler_t =
+      std::function<void(int argc, char **argv, std::string &reply)>;
+  static constexpr std::size_t default_max_frame = 1 << 20;
+
+  // Throws std::runtime_error if the socket cannot be set up.
+  control_server_t(std::string path, handler_t handler,
+                   std::size_t max_frame = default_max_frame);
+  // Closes every connection, and removes the socket.
+  ~control_server_t();
+  control_server_t(const control_server_t &) = delete;
+  control_server_t &operator=(const control_server_t &) = delete;
+
+  const std::string &path() const { return path_; }
+
+  /* Serves until stop() is called. poll() serves for up to timeout_ms
+   * milliseconds instead (-1 to wait for an event), and returns false
+   * once stop() was called.
+   */
+  void run();
+  bool poll(int timeout_ms);
+  // Safe from any thread, e.g. a signal handling one.
+  void stop();
+
+  std::size_t connections() const { return connections_.size(); }
+
+private:
+  struct connection_t {
+    int fd;
+    std::vector<char> in;
+    std::size_t used{0}; // of in, by the frames not yet handled
+    std::string out;     // the replies not yet written
+    std::size_t sent{0}; // of out
+    bool writing{false}; // waiting to write, rather than to read
+  };
+
+  void accept();
+  void receive(connection_t &);
+  bool flush(connection_t &);
+  void close(int fd);
+  void release();
+
+  std::string path_;
+  handler_t handler_;
+  std::size_t max_frame_;
+  int listener_{-1};
+  int epoll_{-1};
+  int wakeup_{-1}; // an eventfd written by stop()
+  std::atomic<bool> stopped_{false};
+  std::unordered_map<int, std::unique_ptr<connection_t>> connections_{};
+  // Reused for every frame.
+  std::vector<char *> argv_{};
+  std::string reply_{};
+};
+
+/* Serves lex on a control_server_t. Every frame is tokenized in place,
+ * skipping argv[0] as tokenize(argc, argv) does, into a container
+ * reused from frame to frame, so that with a std::vector a frame
+ * allocates nothing once one as large was served, and then handed
+ * to on_frame with its argv, as
+ *
+ *   on_frame(std::span<char *const> argv,
+ *            const std::expected<void, lex_error> &status,
+ *            const container_t &tokens, std::string &reply);
+ *
+ * which fills the reply, empty at first. With token_view_t the tokens
+ * view the frame, and with a failed status they are those found
+ * before the error, see try_tokenize_into(). The lexer must outlive
+ * the server, and must not change while it serves.
+ */
+template <typename Lexer, typename F>
+control_server_t serve(const Lexer &lex, std::string path, F on_frame,
+                       std::size_t max_frame =
+                           control_server_t::default_max_frame) {
+  return control_server_t{
+      std::move(path),
+      [&lex, on_frame = std::move(on_frame),
+       tokens = typename Lexer::container_t{}](
+          int argc, char **argv, std::string &reply) mutable {
+        auto status = lex.try_tokenize_into(tokens, argc, argv);
+        on_frame(std::span<char *const>{argv, std::size_t(argc)}, status,
+                 std::as_const(tokens), reply);
+      },
+      max_frame};
+}
+} // namespace glex
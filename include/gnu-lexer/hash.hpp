@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace glex::detail {
+/* Hashes s 8 bytes at a time, continuing from seed. Unlike std::hash,
+ * it is the same for every build, so that the slots of a saved
+ * packed_database_t stay valid.
+ */
+inline std::uint64_t hash(std::string_view s, std::uint64_t seed = 0) noexcept {
+  std::uint64_t h = 0x9e3779b97f4a7c15ull ^ s.size() ^ seed;
+  auto p = s.data();
+  auto n = s.size();
+  for (; n >= 8; p += 8, n -= 8) {
+    std::uint64_t w;
+    std::memcpy(&w, p, 8);
+    h = (h ^ w) * 0xff51afd7ed558ccdull;
+    h ^= h >> 32;
+  }
+  std::uint64_t w = 0;
+  if (n && s.size() >= 8) // the last 8 bytes, overlapping the others
+    std::memcpy(&w, s.data() + s.size() - 8, 8);
+  else
+    for (std::size_t i = 0; i < n; ++i)
+      w = w << 8 | static_cast<unsigned char>(p[i]);
+  h = (h ^ w) * 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  return h ^ (h >> 33);
+}
+} // namespace glex::detail
@@ -1,12 +1,48 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <gnu-lexer/prefix_trie.hpp>
+#include <gnu-lexer/response_file.hpp>
+#include <gnu-lexer/result_cache.hpp>
+#include <gnu-lexer/split.hpp>
 #include <iostream>
+#include <iterator>
 #include <list>
+#include <memory_resource>
 #include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <variant>
 #include <vector>
 
+/* Defined to 1, e.g. by the ENABLE_STATS CMake option, every lexer_t
+ * counts its work, see lexer_t::stats(), in about 4 KB of atomic
+ * counters of its own, copies included, most of them the buckets of
+ * its latency_histogram_t. Otherwise the counting is compiled out.
+ * It must have the same value in every translation unit.
+ */
+#ifndef GLEX_STATS
+#define GLEX_STATS 0
+#endif
+
 namespace glex {
+/* Every argument in a database has a dense integer id, starting at 1
+ * in the order the arguments were added. The id 0 marks a free value.
+ */
+using arg_id_t = std::size_t;
+inline constexpr arg_id_t no_arg = 0;
+
 struct argument_t {
   std::string token;
 
@@ -15,20 +51,507 @@ struct argument_t {
 
   struct value_t {
     enum class type_t { none, single, multi };
+    // What the values are decoded to, see basic_token_t::scalars.
+    enum class element_t : std::uint8_t {
+      string,
+      int64,
+      uint64,
+      real,
+      boolean
+    };
     type_t type;
     char delimiter{0};
+    element_t element{element_t::string};
   };
   value_t value;
+
+  /* Checked while tokenizing, in the same pass, see lex_error::code_t.
+   * An argument may be required, given at least min and at most max
+   * times (0 for no limit), exclusive of the other arguments of its
+   * group (1 to 64, 0 for none), and require another argument,
+   * added before it, to be given too. Only a database_t checks them.
+   */
+  struct constraints_t {
+    bool required{false};
+    std::uint16_t min{0};
+    std::uint16_t max{0};
+    std::uint8_t group{0};
+    arg_id_t depends{no_arg};
+  };
+  constraints_t constraints{};
 };
 
 bool contains(const std::list<argument_t> &, const argument_t &);
 bool contains(const std::vector<argument_t> &, const argument_t &);
+bool contains(const std::deque<argument_t> &, const argument_t &);
 bool is_valid(const argument_t &);
 
-struct token_t {
-  std::string id;
-  std::vector<std::string> values;
+namespace detail {
+// The rules behind is_valid, usable in constant expressions.
+constexpr bool is_valid(std::string_view token, std::string_view verbose,
+                        const argument_t::value_t &value) {
+  if (!token.size())
+    return false;
+  if (!verbose.size())
+    return false;
+  if (value.type == argument_t::value_t::type_t::multi) {
+    auto d = value.delimiter;
+    switch (d) {
+    case 0:
+    case '-':
+    case ' ':
+      return false;
+    }
+    if ((d >= '0' && d <= '9') || (d >= 'a' && d <= 'z') ||
+        (d >= 'A' && d <= 'Z'))
+      return false;
+  }
+  return true;
+}
+} // namespace detail
+
+/* A value decoded while tokenizing, for the arguments whose element
+ * is not a string: an int64, uint64, real (double) or boolean.
+ */
+using scalar_t = std::variant<std::int64_t, std::uint64_t, double, bool>;
+
+/* A token is parametrized by the string type used for its values,
+ * and the type used for its id, by default the same string type.
+ * With std::string the token owns its data, with std::string_view the id
+ * refers to the lexer's database and the values refer to the input chunks.
+ * With arg_id_t the id is the argument's id in the database.
+ *
+ * The values of an argument whose element is not a string are decoded
+ * into scalars, in input order, and the token gets no string values.
+ *
+ * The Allocator is used for the values, and for the id and the token
+ * container when they are allocator aware, e.g. with the glex::pmr types.
+ */
+template <typename String, typename Id = String,
+          typename Allocator = std::allocator<String>>
+struct basic_token_t {
+  using string_type = String;
+  using id_type = Id;
+  // Not named allocator_type, as the token is constructed as an aggregate.
+  using value_allocator_type = Allocator;
+  using scalar_allocator_type = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<scalar_t>;
+  Id id{};
+  std::vector<String, Allocator> values;
+  /* Initialized from an allocator, as with scalars{} GCC 12 crashes
+   * (internal compiler error in nothrow_spec_p) on a braced list of
+   * tokens leaving the scalars out, at any optimization level:
+   *   std::vector<glex::token_t> v = {{.id = "help", .values = {}}};
+   */
+  std::vector<scalar_t, scalar_allocator_type> scalars{scalar_allocator_type{}};
+};
+
+using token_t = basic_token_t<std::string>;
+using token_view_t = basic_token_t<std::string_view>;
+using token_id_t = basic_token_t<std::string, arg_id_t>;
+
+/* The values of a basic_lazy_token_t: the value as found in the input,
+ * with the delimiter of a multi value argument, split only while
+ * iterated. The values are the same as those of a basic_token_t,
+ * as std::string_view referring to the raw value: a trailing delimiter
+ * adds no value. size() and front() do not split the rest of the value,
+ * and to() materializes the values into a container.
+ */
+template <typename String> class lazy_values_t {
+public:
+  class iterator {
+  public:
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::forward_iterator_tag;
+    // The values are not references, as a legacy forward iterator's are.
+    using iterator_category = std::input_iterator_tag;
+
+    iterator() = default; // the end
+
+    std::string_view operator*() const { return tail_.substr(0, len_); }
+    iterator &operator++() {
+      if (len_ == tail_.size()) {
+        *this = {};
+        return *this;
+      }
+      tail_.remove_prefix(len_ + 1);
+      if (tail_.empty())
+        *this = {};
+      else
+        find();
+      return *this;
+    }
+    iterator operator++(int) {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const iterator &o) const {
+      return done_ == o.done_ && (done_ || tail_.data() == o.tail_.data());
+    }
+
+  private:
+    friend class lazy_values_t;
+    iterator(std::string_view raw, char d) : tail_{raw}, d_{d}, done_{false} {
+      find();
+    }
+    void find() {
+      len_ = d_ ? std::min(tail_.find(d_), tail_.size()) : tail_.size();
+    }
+
+    std::string_view tail_{}; // from the current value on
+    std::size_t len_{0};      // of the current value
+    char d_{0}; // none for a single value
+    bool done_{true};
+  };
+
+  // A single value, or the values of v separated by the delimiter d.
+  void assign(std::string_view v, char d = 0) {
+    if constexpr (std::same_as<String, std::string_view>)
+      raw_ = v;
+    else
+      raw_.assign(v);
+    delimiter_ = d;
+    has_ = true;
+  }
+  void clear() {
+    raw_ = {};
+    delimiter_ = 0;
+    has_ = false;
+  }
+
+  iterator begin() const {
+    if (!has_ || (delimiter_ && raw_.empty()))
+      return {};
+    return {std::string_view{raw_}, delimiter_};
+  }
+  iterator end() const { return {}; }
+
+  bool empty() const { return begin() == end(); }
+  std::string_view front() const { return *begin(); }
+
+  // Counts the delimiters, without splitting.
+  std::size_t size() const {
+    if (!has_)
+      return 0;
+    if (!delimiter_)
+      return 1;
+    std::size_t n = 0;
+    detail::split(raw_, delimiter_, [&](std::string_view) { ++n; });
+    return std::string_view{raw_}.ends_with(delimiter_) ? n - 1 : n;
+  }
+
+  std::string_view raw() const { return raw_; }
+  char delimiter() const { return delimiter_; }
+
+  template <typename C = std::vector<String>> C to() const {
+    C out{};
+    for (auto v : *this)
+      out.emplace_back(v);
+    return out;
+  }
+
+  bool operator==(const lazy_values_t &) const = default;
+
+private:
+  String raw_{};
+  char delimiter_{0};
+  bool has_{false};
+};
+
+/* A token whose values are not split while tokenizing, for consumers
+ * that often only look at the id, the first value or the number
+ * of values, see lazy_values_t. With std::string the raw value is
+ * copied once, rather than every value. The scalars of the arguments
+ * whose element is not a string are still decoded while tokenizing.
+ */
+template <typename String, typename Id = String> struct basic_lazy_token_t {
+  using string_type = String;
+  using id_type = Id;
+  using value_allocator_type = std::allocator<String>;
+  using scalar_allocator_type = std::allocator<scalar_t>;
+  Id id{};
+  lazy_values_t<String> values{};
+  // Not scalars{}, see basic_token_t::scalars.
+  std::vector<scalar_t> scalars{scalar_allocator_type{}};
+};
+
+using lazy_token_t = basic_lazy_token_t<std::string>;
+using lazy_token_view_t = basic_lazy_token_t<std::string_view>;
+
+/* Tokens allocating from a std::pmr::memory_resource, for example
+ * a std::pmr::monotonic_buffer_resource releasing a whole call at once.
+ * Use them with a container such as std::pmr::vector, and pass
+ * the resource to tokenize().
+ */
+namespace pmr {
+using allocator_t = std::pmr::polymorphic_allocator<std::pmr::string>;
+using token_t = basic_token_t<std::pmr::string, std::pmr::string, allocator_t>;
+using token_id_t = basic_token_t<std::pmr::string, arg_id_t, allocator_t>;
+} // namespace pmr
+
+namespace detail {
+/* Decodes s as a whole into the element e, with std::from_chars
+ * for numbers. A boolean is one of true, false, yes, no, on, off, 1 or 0.
+ */
+bool decode(std::string_view s, argument_t::value_t::element_t e,
+            scalar_t &out);
+
+// Whether a token id refers to an argument, rather than a free value.
+template <typename Id> constexpr bool has_id(const Id &id) {
+  if constexpr (std::same_as<Id, arg_id_t>)
+    return id != no_arg;
+  else
+    return !id.empty();
+}
+} // namespace detail
+
+struct string_hash {
+  using is_transparent = void;
+  std::size_t operator()(std::string_view s) const noexcept {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+/* The argument database built at runtime with add().
+ * A lexer_t can be used with any database type providing
+ * the verbose() and concise() lookups returning an arg_id_t
+ * (no_arg if not found) and argument() returning the argument
+ * of a valid id, or a view of it, e.g. static_database_t
+ * or packed_database_t.
+ */
+class database_t {
+public:
+  using argument_type = argument_t;
+
+  arg_id_t add(argument_t);
+  void clear();
+
+  arg_id_t verbose(std::string_view name) const {
+    auto it = verbosedb_.find(name);
+    return it != verbosedb_.end() ? it->second : no_arg;
+  }
+
+  arg_id_t concise(char c) const {
+    auto it = concisedb_.find(c);
+    return it != concisedb_.end() ? it->second : no_arg;
+  }
+
+  const argument_t &argument(arg_id_t id) const { return argdb_[id - 1]; }
+  std::size_t size() const { return argdb_.size(); }
+
+  /* Looks up the verbose names starting with prefix, in time linear
+   * in the length of the prefix. The id is only set if a single
+   * name matches, which lexer_t::abbreviations() relies on.
+   */
+  detail::prefix_trie_t::match_t abbreviation(std::string_view prefix) const {
+    return prefixes_.find(prefix);
+  }
+  std::vector<arg_id_t> candidates(std::string_view prefix) const {
+    return prefixes_.candidates(prefix);
+  }
+
+  /* The arguments with constraints, or required by one, in the order
+   * they were added, and the slot of an argument among them
+   * (npos if none), so that a lexer only counts those.
+   */
+  static constexpr std::size_t npos = std::size_t(-1);
+  const std::vector<arg_id_t> &constrained() const { return constrained_; }
+  std::size_t slot(arg_id_t id) const { return slots_[id - 1]; }
+
+private:
+  template <typename T>
+  using strmap_t =
+      std::unordered_map<std::string, T, string_hash, std::equal_to<>>;
+
+  // A deque keeps the arguments in place as more are added,
+  // so token_view_t ids referring to them stay valid.
+  std::deque<argument_t> argdb_;
+  strmap_t<arg_id_t> tokendb_; // only to reject duplicate tokens
+  strmap_t<arg_id_t> verbosedb_;
+  std::unordered_map<char, arg_id_t> concisedb_;
+  detail::prefix_trie_t prefixes_;
+  std::vector<arg_id_t> constrained_;
+  std::vector<std::size_t> slots_; // by id - 1
+};
+} // namespace glex
+
+namespace glex {
+/* Describes why an input failed to tokenize.
+ * The index is the position of the offending chunk in the input
+ * (e.g. in argv) and the offset is the byte offset in that chunk
+ * of the offending argument or value.
+ */
+struct lex_error {
+  enum class code_t : std::uint8_t {
+    short_chunk,      // a chunk that is not a value is shorter than 2
+    empty_value,      // an assigned value is empty, e.g. --opt=
+    bad_arglist_char, // an argument list contains a non letter
+    unknown_concise,  // an argument list contains an unknown argument
+    bad_verbose,      // a verbose argument does not start with a letter
+    unknown_verbose,  // a verbose argument is not in the database
+    unexpected_value, // a flag was assigned a value
+    missing_value,    // the input ended before an argument got its value
+    bad_response,     // a response file could not be read
+    recursive_response, // a response file includes itself
+    ambiguous_verbose,  // an abbreviation matches several verbose arguments
+    bad_value,          // a value does not decode to its argument's element
+    missing_argument,   // an argument is given fewer times than required
+    too_many,           // an argument is given more times than its max
+    exclusive_argument, // another argument of the same group was given
+    missing_dependency, // an argument is given without the one it requires
+    unknown_command,    // a free value does not name a subcommand
+  };
+  code_t code;
+  std::size_t index;
+  std::size_t offset; // 0 if the error is inside a response file
+  /* The argument missing, for missing_argument and missing_dependency.
+   * The index of a missing_argument is the end of the input.
+   */
+  arg_id_t arg{no_arg};
+
+  /* Formats the error, naming the offending argument
+   * if the chunk at the error's index is supplied.
+   */
+  std::string message(std::string_view chunk = {}) const;
+};
+
+/* Describes a step of the tokenization, delivered to a trace_sink_t.
+ * The chunk refers to the input, so it is only valid during the call.
+ */
+struct trace_event_t {
+  enum class kind_t : std::uint8_t {
+    chunk,   // a chunk is about to be analyzed
+    value,   // the chunk is the value of the previous argument
+    arglist, // the chunk is a list of concise arguments
+    longarg, // the chunk is a verbose argument
+    freearg, // the chunk is a free value, or the "--"
+    matched, // the argument with id arg was found in the chunk
+  };
+  kind_t kind;
+  std::size_t index; // of the chunk in the input
+  std::string_view chunk;
+  arg_id_t arg{no_arg};
+};
+
+/* Receives the trace events of a lexer_t.
+ * A sink shared by lexers used from several threads
+ * must handle concurrent calls to event().
+ */
+struct trace_sink_t {
+  virtual ~trace_sink_t() = default;
+  virtual void event(const trace_event_t &) = 0;
+};
+
+// Prints every event to std::cout, used by lexer_t::debug(true).
+trace_sink_t &stdout_trace();
+
+/* What the word at the cursor of a partial input may be completed with,
+ * see lexer_t::complete(). The candidates are whole words, in order,
+ * replacing the word at the cursor.
+ */
+struct completion_t {
+  enum class kind_t : std::uint8_t {
+    argument, // a verbose argument, or a list of concise arguments
+    value,    // the value of the argument arg, or of an unknown one
+    free,     // a free value, e.g. a file name
+  };
+  kind_t kind;
+  arg_id_t arg{no_arg};
+  std::vector<std::string> candidates{};
+};
+
+namespace detail {
+/* Completes the value of an argument starting at start in word,
+ * or its last value in a list. Only booleans have candidates.
+ */
+void complete_value(completion_t &, std::string_view word, std::size_t start,
+                    const argument_t::value_t &);
+} // namespace detail
+
+/* What a lexer_t counted, see lexer_t::stats().
+ * A call is a tokenize(), try_tokenize(), tokenize_into() or
+ * try_tokenize_into() call, or an input of tokenize_batch().
+ * The chunks, bytes, lookups and errors include those of streams.
+ */
+struct counts_t {
+  // One per lex_error::code_t.
+  static constexpr std::size_t nerrors =
+      std::size_t(lex_error::code_t::unknown_command) + 1;
+
+  std::uint64_t calls{0};
+  std::uint64_t bytes{0}; // of the chunks analyzed
+  // The chunks by classification, see trace_event_t::kind_t.
+  std::uint64_t value_chunks{0};
+  std::uint64_t arglist_chunks{0};
+  std::uint64_t longarg_chunks{0};
+  std::uint64_t freearg_chunks{0};
+  // A miss is a name the database does not hold.
+  std::uint64_t verbose_lookups{0};
+  std::uint64_t verbose_misses{0};
+  std::uint64_t concise_lookups{0};
+  std::uint64_t concise_misses{0};
+  std::uint64_t values_split{0}; // out of multi value lists
+  std::array<std::uint64_t, nerrors> errors{}; // indexed by code
+
+  std::uint64_t errors_of(lex_error::code_t code) const {
+    return errors[std::size_t(code)];
+  }
+  counts_t &operator+=(const counts_t &);
+};
+
+/* The latencies of the calls, in nanoseconds, in buckets of
+ * logarithmic width: 8 per power of two, so a bucket holds values
+ * within 12.5% of each other, as in an HdrHistogram with
+ * one significant digit.
+ */
+struct latency_histogram_t {
+  static constexpr unsigned sub_bits = 3;
+  static constexpr std::size_t nbuckets = (64 - sub_bits + 1) << sub_bits;
+
+  std::array<std::uint64_t, nbuckets> counts{};
+
+  static std::size_t bucket(std::uint64_t ns);
+  static std::uint64_t lowest(std::size_t bucket); // of the values in it
+  static std::uint64_t highest(std::size_t bucket);
+
+  std::uint64_t total() const;
+  // The highest value of the bucket holding the p-th quantile, p in [0, 1].
+  std::uint64_t percentile(double p) const;
+};
+
+struct stats_t {
+  counts_t counts;
+  latency_histogram_t latency;
 };
+
+namespace detail {
+/* The counters of a lexer, shared by its calls. A call counts
+ * into its own counts_t, and adds it here with relaxed atomic
+ * additions once it is done, so they are only read together.
+ */
+class counters_t {
+public:
+  counters_t() = default;
+  // A copy of a lexer counts on its own.
+  counters_t(const counters_t &) {}
+  counters_t &operator=(const counters_t &) { return *this; }
+
+  void add(const counts_t &);
+  void record(std::uint64_t ns);
+  stats_t snapshot() const;
+  void reset();
+
+private:
+  using counter_t = std::atomic<std::uint64_t>;
+  static constexpr std::size_t nfields = 11;
+
+  std::array<counter_t, nfields> fields_{};
+  std::array<counter_t, counts_t::nerrors> errors_{};
+  std::array<counter_t, latency_histogram_t::nbuckets> latency_{};
+};
+} // namespace detail
 } // namespace glex
 
 bool operator!=(const glex::argument_t &a, const glex::argument_t &b);
@@ -57,113 +580,748 @@ int count(int a, char **b, const std::string &c, int d = 1);
 } // namespace glex
 
 namespace glex {
-template <template <typename, typename...> typename ContainerType>
+/* The Token type selects what the generated tokens hold.
+ * A lexer_t producing token_view_t does not copy its input,
+ * so the tokens are only valid as long as the input (e.g. argv)
+ * and the lexer's database are.
+ *
+ * The Database type holds the arguments, by default the database_t
+ * populated with add().
+ */
+template <template <typename, typename...> typename ContainerType,
+          typename Token = token_t, typename Database = database_t>
 class lexer_t {
 public:
-  using container_t = ContainerType<token_t>;
+  using token_type = Token;
+  using container_t = ContainerType<Token>;
+  using database_type = Database;
+  using argument_type = typename std::remove_cv_t<Database>::argument_type;
+  using allocator_type = typename Token::value_allocator_type;
 
-  container_t tokenize(int argc, char **argv, int skip = 1) const {
-    return tokenize(read(argv, argc, 0), skip);
-  }
+  lexer_t() = default;
+  explicit lexer_t(Database db) : db_{std::move(db)} {}
 
   using input_t = std::vector<std::string>;
   using offset_t = typename input_t::size_type;
-  container_t tokenize(const input_t &, const offset_t & = 0) const;
+  using result_t = std::expected<container_t, lex_error>;
+  // A result shared with the cache, see cache().
+  using shared_result_t =
+      std::expected<std::shared_ptr<const container_t>, lex_error>;
 
-  void add(argument_t arg) {
-    if (!is_valid(arg) || contains(argdb_, arg)) {
-      throw std::runtime_error{"The supplied arg is invalid!"};
-    }
-    argdb_.push_back(std::move(arg));
-    verbosedb_.emplace(argdb_.back().verbose, &argdb_.back());
-    if (argdb_.back().concise)
-      concisedb_.emplace(argdb_.back().concise, &argdb_.back());
-    tokendb_.emplace(argdb_.back().token, &argdb_.back());
+  /* The allocator, if given, is used for all the memory of the result,
+   * e.g. a std::pmr::memory_resource * with the glex::pmr tokens.
+   */
+  container_t tokenize(int argc, char **argv, int skip = 1,
+                       const allocator_type &alloc = {}) const {
+    auto r = try_tokenize(argc, argv, skip, alloc);
+    if (!r)
+      throw std::runtime_error{
+          message(r.error(), chunk_of(r.error(), argc, argv))};
+    return std::move(*r);
+  }
+
+  container_t tokenize(const input_t &in, const offset_t &off = 0,
+                       const allocator_type &alloc = {}) const {
+    auto r = try_tokenize(in, off, alloc);
+    if (!r)
+      throw std::runtime_error{message(r.error(), chunk_of(r.error(), in))};
+    return std::move(*r);
+  }
+
+  // Tokens viewing a temporary input would dangle.
+  container_t tokenize(const input_t &&, const offset_t & = 0,
+                       const allocator_type & = {}) const
+    requires std::same_as<typename Token::string_type, std::string_view>
+  = delete;
+
+  /* The same as tokenize(), but a malformed input is reported
+   * through the returned lex_error instead of an exception.
+   */
+  result_t try_tokenize(int argc, char **argv, int skip = 1,
+                        const allocator_type &alloc = {}) const {
+    context_t ctx{alloc};
+    for (ctx.index = skip; ctx.index < std::size_t(argc); ++ctx.index)
+      if (!feed(ctx, std::string_view{argv[ctx.index]}))
+        break;
+    return finish(ctx);
+  }
+
+  result_t try_tokenize(const input_t &, const offset_t & = 0,
+                        const allocator_type & = {}) const;
+
+  result_t try_tokenize(const input_t &&, const offset_t & = 0,
+                        const allocator_type & = {}) const
+    requires std::same_as<typename Token::string_type, std::string_view>
+  = delete;
+
+  /* The same as try_tokenize(), but stops at the first free value
+   * that does not follow a "--", e.g. the name of a subcommand,
+   * see command_t. off is moved to the index of that chunk, or to
+   * the end of the input, and the tokens before it are validated.
+   */
+  result_t try_tokenize_head(int argc, char **argv, offset_t &off) const {
+    return head(std::size_t(argc), off,
+                [&](std::size_t i) { return std::string_view{argv[i]}; });
+  }
+
+  result_t try_tokenize_head(const input_t &in, offset_t &off) const {
+    return head(in.size(), off,
+                [&](std::size_t i) { return std::string_view{in[i]}; });
+  }
+
+  result_t try_tokenize_head(const input_t &&, offset_t &) const
+    requires std::same_as<typename Token::string_type, std::string_view>
+  = delete;
+
+  /* Tokenizes into out, overwriting its tokens, and the strings
+   * of their ids and values, instead of allocating new ones.
+   * A call whose tokens fit in those already in out, e.g. in a loop
+   * tokenizing the same kind of input, does not allocate with
+   * a std::vector. The memory comes from out's allocator.
+   * If the input is malformed, out holds the tokens found before the error.
+   */
+  void tokenize_into(container_t &out, int argc, char **argv,
+                     int skip = 1) const {
+    auto r = try_tokenize_into(out, argc, argv, skip);
+    if (!r)
+      throw std::runtime_error{
+          message(r.error(), chunk_of(r.error(), argc, argv))};
+  }
+
+  void tokenize_into(container_t &out, const input_t &in,
+                     const offset_t &off = 0) const {
+    auto r = try_tokenize_into(out, in, off);
+    if (!r)
+      throw std::runtime_error{message(r.error(), chunk_of(r.error(), in))};
+  }
+
+  void tokenize_into(container_t &, const input_t &&,
+                     const offset_t & = 0) const
+    requires std::same_as<typename Token::string_type, std::string_view>
+  = delete;
+
+  std::expected<void, lex_error>
+  try_tokenize_into(container_t &out, int argc, char **argv,
+                    int skip = 1) const {
+    context_t ctx{std::move(out)};
+    for (ctx.index = skip; ctx.index < std::size_t(argc); ++ctx.index)
+      if (!feed(ctx, std::string_view{argv[ctx.index]}))
+        break;
+    return finish_into(ctx, out);
   }
 
+  std::expected<void, lex_error>
+  try_tokenize_into(container_t &out, const input_t &in,
+                    const offset_t &off = 0) const {
+    context_t ctx{std::move(out)};
+    for (ctx.index = off; ctx.index < in.size(); ++ctx.index)
+      if (!feed(ctx, std::string_view{in[ctx.index]}))
+        break;
+    return finish_into(ctx, out);
+  }
+
+  std::expected<void, lex_error>
+  try_tokenize_into(container_t &, const input_t &&,
+                    const offset_t & = 0) const
+    requires std::same_as<typename Token::string_type, std::string_view>
+  = delete;
+
+  /* The same as try_tokenize(), but with the cache enabled, an input
+   * tokenized before, from the same offset, returns the same result
+   * without tokenizing it again. The result is immutable, as it is
+   * shared with the cache and every other caller of that input.
+   */
+  shared_result_t try_tokenize_shared(int argc, char **argv,
+                                      int skip = 1) const
+    requires(!std::same_as<typename Token::string_type, std::string_view>)
+  {
+    auto chunks = std::span{argv, std::size_t(argc)} |
+                  std::views::transform(
+                      [](const char *c) { return std::string_view{c}; });
+    return cached(chunks, skip, [&] { return try_tokenize(argc, argv, skip); });
+  }
+
+  shared_result_t try_tokenize_shared(const input_t &in,
+                                      const offset_t &off = 0) const
+    requires(!std::same_as<typename Token::string_type, std::string_view>)
+  {
+    return cached(in, off, [&] { return try_tokenize(in, off); });
+  }
+
+  std::shared_ptr<const container_t> tokenize_shared(int argc, char **argv,
+                                                     int skip = 1) const {
+    auto r = try_tokenize_shared(argc, argv, skip);
+    if (!r)
+      throw std::runtime_error{
+          message(r.error(), chunk_of(r.error(), argc, argv))};
+    return std::move(*r);
+  }
+
+  std::shared_ptr<const container_t>
+  tokenize_shared(const input_t &in, const offset_t &off = 0) const {
+    auto r = try_tokenize_shared(in, off);
+    if (!r)
+      throw std::runtime_error{message(r.error(), chunk_of(r.error(), in))};
+    return std::move(*r);
+  }
+
+  /* The same as try_tokenize(), with the chunks of a single large input
+   * spread over up to nthreads threads, e.g. for millions of chunks
+   * expanded from globs. The result is the same as try_tokenize()'s.
+   *
+   * The input is cut into segments after chunks that cannot be followed
+   * by a value, nor start the hyphen mode, whatever comes before them.
+   * Every segment is tokenized on its own as if the hyphen mode was off,
+   * and the segments following one that turned it on are tokenized
+   * again with it on, all in parallel, then the segments are joined.
+   *
+   * An input of less than parallel_grain chunks per thread, or a lexer
+   * with a trace sink, is tokenized by the calling thread alone.
+   * With nthreads equal to 0, std::thread::hardware_concurrency() is used.
+   */
+  static constexpr std::size_t parallel_grain = 4096;
+
+  container_t tokenize_parallel(const input_t &in, const offset_t &off = 0,
+                                std::size_t nthreads = 0,
+                                const allocator_type &alloc = {}) const {
+    auto r = try_tokenize_parallel(in, off, nthreads, alloc);
+    if (!r)
+      throw std::runtime_error{message(r.error(), chunk_of(r.error(), in))};
+    return std::move(*r);
+  }
+
+  result_t try_tokenize_parallel(const input_t &, const offset_t & = 0,
+                                 std::size_t nthreads = 0,
+                                 const allocator_type & = {}) const;
+
+  result_t try_tokenize_parallel(const input_t &&, const offset_t & = 0,
+                                 std::size_t = 0,
+                                 const allocator_type & = {}) const
+    requires std::same_as<typename Token::string_type, std::string_view>
+  = delete;
+
+  /* Tokenizes every input, spreading them over up to nthreads threads.
+   * The results are in input order, and an input that fails to tokenize
+   * holds its error instead of aborting the whole batch.
+   * With nthreads equal to 0, std::thread::hardware_concurrency() is used.
+   */
+  std::vector<result_t> tokenize_batch(std::span<const input_t>,
+                                       std::size_t nthreads = 0) const;
+
+  /* Tokenizes the input incrementally, one chunk at a time.
+   * Every push() hands the tokens completed by that chunk to the callback,
+   * and finish() hands over the rest after validating the input.
+   * A stream_t producing token_view_t requires the chunks to outlive
+   * the tokens, and must not be used further once it has thrown.
+   */
+  class stream_t;
+  stream_t stream(const allocator_type &alloc = {}) const {
+    return stream_t{*this, alloc};
+  }
+
+  arg_id_t add(argument_t arg) {
+    cache_.clear();
+    return db_.add(std::move(arg));
+  }
   void clear() {
-    argdb_.clear();
-    verbosedb_.clear();
-    concisedb_.clear();
-    tokendb_.clear();
+    cache_.clear();
+    db_.clear();
   };
+  const Database &database() const { return db_; }
 
-  void debug(bool v) { dbg_ = v; }
-  bool debug() const { return dbg_; }
+  // Map the id of a token_id_t back to its argument.
+  decltype(auto) argument(arg_id_t id) const { return db_.argument(id); }
+  std::string_view name(arg_id_t id) const { return argument(id).token; }
+
+  /* Finds what the word at index cursor of a partial input, e.g. the argv
+   * of a shell completion request, may be completed with. The chunks
+   * before it are tokenized, skipping malformed ones, to know whether
+   * it is a value, after a "--", or an argument. Verbose arguments are
+   * found by prefix, in the trie of a database_t.
+   * A cursor at in.size() completes an empty word.
+   */
+  completion_t complete(const input_t &in, std::size_t cursor,
+                        const offset_t &off = 0) const;
+
+  /* Tracing is off by default, and then costs a single branch per step.
+   * The sink must outlive the lexer's tokenize calls.
+   */
+  void trace(trace_sink_t *sink) { sink_ = sink; }
+  trace_sink_t *trace() const { return sink_; }
+
+  /* With response files enabled, a chunk @path is replaced
+   * by the chunks of the file at path, see response_file_t.
+   * The chunks are only valid during the call,
+   * so tokens viewing the input cannot use them.
+   */
+  void response_files(bool v)
+    requires(!std::same_as<typename Token::string_type, std::string_view>)
+  {
+    cache_.clear();
+    rsp_ = v;
+  }
+  bool response_files() const { return rsp_; }
+
+  /* With abbreviations enabled, a verbose argument may be shortened
+   * to any prefix matching a single argument, e.g. --ver for --verbose,
+   * as getopt_long() allows. An exact match always wins.
+   */
+  void abbreviations(bool v)
+    requires requires(const Database &db) { db.abbreviation(""); }
+  {
+    cache_.clear();
+    abbrev_ = v;
+  }
+  bool abbreviations() const { return abbrev_; }
+
+  /* Formats the error as lex_error::message() does,
+   * listing the candidates of an ambiguous abbreviation.
+   */
+  std::string message(const lex_error &, std::string_view chunk) const;
+
+  /* With a capacity, try_tokenize_shared() keeps the results of up to
+   * that many inputs, errors included, evicting the least recently
+   * used. The cache is safe to use from many threads, and is emptied
+   * whenever the database or the options change. 0, the default,
+   * disables it, and then nothing is allocated for it.
+   * An input with @path chunks is never cached when response files
+   * are enabled, as the files may change between calls.
+   */
+  void cache(std::size_t capacity) { cache_.resize(capacity); }
+  std::size_t cache() const { return cache_.capacity(); }
+  cache_stats_t cache_stats() const { return cache_.stats(); }
+
+  void debug(bool v) { sink_ = v ? &stdout_trace() : nullptr; }
+  bool debug() const { return sink_ == &stdout_trace(); }
+
+#if GLEX_STATS
+  /* What the lexer counted since it was created or last reset,
+   * from every thread. A call adds its counts once it is done,
+   * a stream after every chunk.
+   */
+  stats_t stats() const { return counters_.snapshot(); }
+  void reset_stats() { counters_.reset(); }
+#endif
 
 private:
-  void assign(const std::string &) const;
-  void tokenize(const std::string &) const;
-  bool handle_value(const std::string &chunk) const;
-  bool handle_arglist(const std::string &chunk) const;
-  bool is_arglist(const std::string &chunk) const;
-  bool handle_longarg(const std::string &chunk) const;
-  bool is_longarg(const std::string &chunk) const;
-  bool handle_freearg(const std::string &chunk) const;
+  // The state of a single tokenize() call.
+  struct context_t {
+    explicit context_t(const allocator_type &a = {})
+        : tokens{make_container(a)}, alloc{a} {}
+
+    // Fills the tokens of a previous call again, see tokenize_into().
+    explicit context_t(container_t &&reuse)
+        : tokens{std::move(reuse)}, alloc(tokens.get_allocator()) {
+      if constexpr (!reusable)
+        tokens.clear();
+    }
+
+    container_t tokens;
+    allocator_type alloc;
+    std::size_t ntokens{0}; // in use, the others are spares to reuse
+    std::size_t nvalues{0}; // in use in the last token
+    argument_t::value_t active{}; // of the last argument found
+    arg_id_t active_id{no_arg};
+    std::size_t active_index{0}; // where the active argument was found
+    std::size_t active_offset{0};
+    std::size_t index{0};  // of the current chunk
+    std::size_t opened{0}; // of the chunk that opened the last token
+    std::string_view chunk{};
+    std::vector<response_file_t::id_t> files{}; // being expanded
+    lex_error error{};
+    bool failed{false};
+    bool hyphen{false};
+    bool value{false};
+    bool skip{false};
+    // Of the arguments with constraints, by slot, see violates().
+    struct seen_t {
+      std::uint16_t count{0};
+      std::size_t index{0}; // of the first occurrence
+      std::size_t offset{0};
+    };
+    std::vector<seen_t> seen{};
+    std::uint64_t groups{0}; // one bit per group given
+#if GLEX_STATS
+    counts_t counts{};
+    std::chrono::steady_clock::time_point start{
+        std::chrono::steady_clock::now()};
+#endif
+
+    // Starts over, keeping the allocator.
+    void reset() {
+      tokens.clear();
+      ntokens = nvalues = 0;
+      active = {};
+      active_id = no_arg;
+      active_index = active_offset = index = opened = 0;
+      chunk = {};
+      files.clear();
+      error = {};
+      failed = hyphen = value = skip = false;
+      seen.clear();
+      groups = 0;
+#if GLEX_STATS
+      counts = {};
+      start = std::chrono::steady_clock::now();
+#endif
+    }
+  };
+
+  // Records the error found at pos, a position in the current chunk.
+  static bool fail(context_t &ctx, lex_error::code_t code,
+                   std::string_view::size_type pos) {
+    ctx.error = {.code = code, .index = ctx.index, .offset = pos};
+    ctx.failed = true;
+    return true;
+  }
+
+  static void activate(context_t &ctx, arg_id_t id,
+                       const argument_t::value_t &value,
+                       std::string_view::size_type pos) {
+    ctx.active = value;
+    ctx.active_id = id;
+    ctx.active_index = ctx.index;
+    ctx.active_offset = ctx.files.empty() ? pos : 0;
+  }
 
-  void logdbg(const std::string &s) const {
-    if (debug())
-      std::cout << "DBG: " << s << std::endl;
+  /* Counts the argument id found at pos against its constraints,
+   * failing if it is given too many times or after another argument
+   * of its group. Only the arguments in database_t::constrained()
+   * have a slot, so the rest cost a single lookup.
+   */
+  bool violates(context_t &, arg_id_t, std::string_view::size_type pos) const;
+
+  // The chunk an error refers to, none past the end of the input.
+  static std::string_view chunk_of(const lex_error &e, const input_t &in) {
+    return e.index < in.size() ? std::string_view{in[e.index]}
+                               : std::string_view{};
+  }
+  static std::string_view chunk_of(const lex_error &e, int argc,
+                                   char **argv) {
+    return e.index < std::size_t(argc) ? std::string_view{argv[e.index]}
+                                       : std::string_view{};
+  }
+
+  result_t finish(context_t &) const;
+  std::expected<void, lex_error> finish_into(context_t &, container_t &) const;
+  bool validate(context_t &) const;
+  bool assign(context_t &, std::string_view) const;
+  bool tokenize(context_t &, std::string_view) const;
+  bool feed(context_t &, std::string_view) const;
+  bool clean_after(std::string_view chunk, const allocator_type &) const;
+  bool is_freearg(const context_t &, std::string_view chunk) const;
+  template <typename F>
+  result_t head(std::size_t n, offset_t &off, F &&chunk) const;
+  arg_id_t lookup_verbose(std::string_view name) const;
+  completion_t complete_value(std::string_view word, std::size_t start,
+                              arg_id_t id) const;
+  void join(context_t &, context_t &) const;
+  bool expand(context_t &, std::string_view path) const;
+  bool handle_value(context_t &, std::string_view chunk) const;
+  bool handle_arglist(context_t &, std::string_view chunk) const;
+  bool is_arglist(const context_t &, std::string_view chunk) const;
+  bool handle_longarg(context_t &, std::string_view chunk) const;
+  bool is_longarg(const context_t &, std::string_view chunk) const;
+  bool handle_freearg(context_t &, std::string_view chunk) const;
+
+  static container_t make_container(const allocator_type &a) {
+    if constexpr (std::uses_allocator_v<container_t, allocator_type>)
+      return container_t(a);
+    else
+      return container_t{};
+  }
+
+  static Token make_token(const context_t &ctx) {
+    using id_t = typename Token::id_type;
+    using values_t = decltype(Token::values);
+    using scalars_t = decltype(Token::scalars);
+    if constexpr (lazy)
+      return {.id = id_t{},
+              .values = values_t{},
+              .scalars = scalars_t(ctx.alloc)};
+    else if constexpr (std::uses_allocator_v<id_t, allocator_type>)
+      return {.id = id_t(ctx.alloc),
+              .values = values_t(ctx.alloc),
+              .scalars = scalars_t(ctx.alloc)};
+    else
+      return {.id = id_t{},
+              .values = values_t(ctx.alloc),
+              .scalars = scalars_t(ctx.alloc)};
+  }
+
+  /* Spare tokens, and the spare values of a token, are overwritten
+   * in place, so that the strings keep their storage.
+   * Only containers with random access keep spare tokens.
+   */
+  static constexpr bool reusable =
+      std::ranges::random_access_range<container_t>;
+
+  // Whether the values are split as they are read, see lazy_values_t.
+  static constexpr bool lazy =
+      requires(const Token &t) { t.values.delimiter(); };
+
+  template <typename S> static void assign_string(S &s, std::string_view v) {
+    if constexpr (std::same_as<S, std::string_view>)
+      s = v;
+    else
+      s.assign(v);
+  }
+
+  static void set_id(Token &t, arg_id_t id, const argument_type &arg) {
+    if constexpr (std::same_as<typename Token::id_type, arg_id_t>)
+      t.id = id;
+    else
+      assign_string(t.id, arg.token);
+  }
+
+  // The token the current chunk fills.
+  static Token &back(context_t &ctx) {
+    if constexpr (reusable)
+      return ctx.tokens[ctx.ntokens - 1];
+    else
+      return ctx.tokens.back();
+  }
+
+  static Token &open_token(context_t &ctx) {
+    if (ctx.ntokens)
+      trim(ctx);
+    ctx.nvalues = 0;
+    ctx.opened = ctx.index;
+    if constexpr (reusable) {
+      if (ctx.ntokens < ctx.tokens.size()) {
+        auto &t = ctx.tokens[ctx.ntokens++];
+        if constexpr (requires { t.id.clear(); })
+          t.id.clear(); // keeps the storage
+        else
+          t.id = {};
+        t.scalars.clear();
+        return t;
+      }
+    }
+    ++ctx.ntokens;
+    return ctx.tokens.emplace_back(make_token(ctx));
+  }
+
+  static void add_scalar(context_t &ctx, std::string_view v) {
+    scalar_t s{};
+    if (!detail::decode(v, ctx.active.element, s))
+      fail(ctx, lex_error::code_t::bad_value, v.data() - ctx.chunk.data());
+    else
+      back(ctx).scalars.push_back(s);
+  }
+
+  static void add_value(context_t &ctx, std::string_view v) {
+    auto &values = back(ctx).values;
+    if constexpr (lazy) {
+      values.assign(v);
+      ctx.nvalues = 1;
+    } else {
+      if (ctx.nvalues < values.size())
+        assign_string(values[ctx.nvalues], v);
+      else
+        values.emplace_back(v);
+      ++ctx.nvalues;
+    }
+  }
+
+  // Drops the spare values of the last token.
+  static void trim(context_t &ctx) {
+    auto &values = back(ctx).values;
+    if constexpr (lazy) {
+      if (!ctx.nvalues)
+        values.clear();
+    } else {
+      values.erase(values.begin() + ctx.nvalues, values.end());
+    }
+  }
+
+  // Drops every spare, once the input is tokenized.
+  static void seal(context_t &ctx) {
+    if (ctx.ntokens)
+      trim(ctx);
+    if constexpr (reusable)
+      ctx.tokens.erase(ctx.tokens.begin() + ctx.ntokens, ctx.tokens.end());
+  }
+
+  // Counts into the counts_t of the call, only with GLEX_STATS.
+#if GLEX_STATS
+  template <typename F> static void tally(context_t &ctx, F &&f) {
+    f(ctx.counts);
+  }
+#else
+  template <typename F> static void tally(context_t &, F &&) {}
+#endif
+
+  /* Adds the counts of the call to those of the lexer, with its error
+   * and, once the call is done, its latency.
+   */
+  void record([[maybe_unused]] context_t &ctx,
+              [[maybe_unused]] bool done) const {
+#if GLEX_STATS
+    if (ctx.failed)
+      ++ctx.counts.errors[std::size_t(ctx.error.code)];
+    if (done) {
+      ++ctx.counts.calls;
+      auto elapsed = std::chrono::steady_clock::now() - ctx.start;
+      counters_.record(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count());
+    }
+    counters_.add(ctx.counts);
+    ctx.counts = {};
+#endif
+  }
+
+  template <typename R, typename F>
+  shared_result_t cached(const R &chunks, std::size_t off, F &&run) const {
+    const auto share = [](result_t r) -> shared_result_t {
+      if (!r)
+        return std::unexpected{r.error()};
+      return std::make_shared<const container_t>(std::move(*r));
+    };
+    const auto response = [&](std::string_view c) {
+      return c.size() >= 2 && c.front() == '@';
+    };
+    if (!cache_.capacity() ||
+        (rsp_ && std::ranges::any_of(chunks | std::views::drop(off), response)))
+      return share(run());
+
+    auto h = cache_.hash(chunks, off);
+    if (auto hit = cache_.find(h, chunks, off))
+      return std::move(*hit);
+    auto r = share(run());
+    cache_.insert(h, chunks, off, r);
+    return r;
+  }
+
+  void emit(const context_t &ctx, trace_event_t::kind_t kind,
+            arg_id_t arg = no_arg) const {
+    if (sink_) [[unlikely]]
+      sink_->event(
+          {.kind = kind, .index = ctx.index, .chunk = ctx.chunk, .arg = arg});
   }
 
 private:
-  std::list<argument_t> argdb_;
-  std::unordered_map<std::string, argument_t *> verbosedb_;
-  std::unordered_map<std::string, argument_t *> tokendb_;
-  std::unordered_map<char, argument_t *> concisedb_;
-  mutable container_t tokens_;
-  mutable bool hyphen_{false};
-  mutable bool value_{false};
-  mutable bool skip_{false};
-  bool dbg_{false};
+  Database db_;
+  trace_sink_t *sink_{nullptr};
+  bool rsp_{false};
+  bool abbrev_{false};
+  mutable detail::result_cache_t<shared_result_t> cache_{};
+#if GLEX_STATS
+  mutable detail::counters_t counters_{};
+#endif
 };
 } // namespace glex
 
 /************************************* IMPLEMENTATION *************************/
 namespace glex {
-template <template <typename, typename...> typename C>
-void lexer_t<C>::assign(const std::string &v) const {
-  std::string val{v.front() == '=' ? v.begin() + 1 : v.begin(), v.end()};
+template <template <typename, typename...> typename C, typename T, typename D>
+class lexer_t<C, T, D>::stream_t {
+public:
+  stream_t(const lexer_t &lex, const allocator_type &alloc)
+      : lex_{lex}, ctx_{alloc} {}
+
+  template <std::invocable<T &&> F> void push(std::string_view chunk, F &&f) {
+    bool ok = lex_.feed(ctx_, chunk);
+    lex_.record(ctx_, false);
+    if (!ok)
+      throw std::runtime_error{lex_.message(ctx_.error, chunk)};
+    ++ctx_.index;
+    // The last token is still open while it waits for a value,
+    // or for the chunk following a "--".
+    auto open = ctx_.value || ctx_.skip ? 1u : 0u;
+    if (ctx_.ntokens)
+      lex_.trim(ctx_);
+    for (; ctx_.ntokens > open; --ctx_.ntokens) {
+      f(std::move(ctx_.tokens.front()));
+      ctx_.tokens.erase(ctx_.tokens.begin());
+    }
+  }
+
+  template <std::invocable<T &&> F> void finish(F &&f) {
+    bool ok = lex_.validate(ctx_);
+    lex_.record(ctx_, false);
+    if (!ok)
+      throw std::runtime_error{lex_.message(ctx_.error, {})};
+    lex_.seal(ctx_);
+    for (auto &t : ctx_.tokens)
+      f(std::move(t));
+    ctx_.reset();
+  }
+
+private:
+  const lexer_t &lex_;
+  context_t ctx_{};
+};
+
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::assign(context_t &ctx, std::string_view v) const {
+  auto val = v.front() == '=' ? v.substr(1) : v;
   if (!val.size())
-    throw std::runtime_error{"An assigned value cannot be empty."};
+    return !fail(ctx, lex_error::code_t::empty_value,
+                 val.data() - ctx.chunk.data());
 
-  auto active = tokendb_.at(tokens_.back().id);
+  const auto &active = ctx.active;
   using avt = argument_t::value_t::type_t;
-  if (active->value.type == avt::single) {
-    tokens_.back().values.push_back(std::move(val));
-    return;
-  }
-
-  using namespace std::ranges;
-  tokens_.back().values = views::split(val, active->value.delimiter) |
-                          views::transform([](const auto &s) {
-                            return std::string{s.begin(), s.end()};
-                          }) |
-                          to<std::vector>();
-  if (tokens_.back().values.back().empty())
-    tokens_.back().values.pop_back();
+  if (active.element != argument_t::value_t::element_t::string) {
+    if (active.type == avt::single) {
+      add_scalar(ctx, val);
+      return !ctx.failed;
+    }
+    auto &scalars = back(ctx).scalars;
+    scalars.clear();
+    detail::split(val, active.delimiter, [&](std::string_view part) {
+      // Like for strings, a trailing delimiter adds no value.
+      if (!ctx.failed && (part.size() || part.end() != val.end()))
+        add_scalar(ctx, part);
+    });
+    tally(ctx, [&](auto &c) { c.values_split += scalars.size(); });
+    return !ctx.failed;
+  }
+
+  if (active.type == avt::single) {
+    add_value(ctx, val);
+    return true;
+  }
+
+  // Kept whole, and split once read.
+  if constexpr (lazy) {
+    auto &values = back(ctx).values;
+    values.assign(val, active.delimiter);
+    ctx.nvalues = 1;
+    // Only with GLEX_STATS do the delimiters get counted here.
+    tally(ctx, [&](auto &c) { c.values_split += values.size(); });
+  } else {
+    ctx.nvalues = 0;
+    detail::split(val, active.delimiter,
+                  [&](std::string_view part) { add_value(ctx, part); });
+    if (back(ctx).values[ctx.nvalues - 1].empty())
+      --ctx.nvalues;
+    tally(ctx, [&](auto &c) { c.values_split += ctx.nvalues; });
+  }
+  return true;
 }
 
-template <template <typename, typename...> typename C>
-bool lexer_t<C>::handle_value(const std::string &chunk) const {
-  if (!value_)
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::handle_value(context_t &ctx,
+                                    std::string_view chunk) const {
+  if (!ctx.value)
     return false;
-  value_ = false;
+  ctx.value = false;
 
-  logdbg("Chunk identified as: value");
+  emit(ctx, trace_event_t::kind_t::value);
 
-  assign(chunk);
+  assign(ctx, chunk);
   return true;
 }
 
-template <template <typename, typename...> typename C>
-bool lexer_t<C>::is_arglist(const std::string &chunk) const {
-  if (hyphen_)
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::is_arglist(const context_t &ctx,
+                                  std::string_view chunk) const {
+  if (ctx.hyphen)
     return false;
   if (chunk.size() < 2)
-    throw std::runtime_error{
-        "Hyphen mode is not active, and the current chunk is not supposed to "
-        "be a value, so the chunk must be at least 2 characters long."};
+    return true; // reported by handle_arglist
   if (chunk[0] != '-')
     return false;
   if (chunk[1] == '-')
@@ -171,45 +1329,55 @@ bool lexer_t<C>::is_arglist(const std::string &chunk) const {
   return true;
 }
 
-template <template <typename, typename...> typename C>
-bool lexer_t<C>::handle_arglist(const std::string &chunk) const {
-  if (!is_arglist(chunk))
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::handle_arglist(context_t &ctx,
+                                      std::string_view chunk) const {
+  if (!is_arglist(ctx, chunk))
     return false;
-  logdbg("Chunk identified as: arglist");
+  if (chunk.size() < 2)
+    return fail(ctx, lex_error::code_t::short_chunk, 0);
+  emit(ctx, trace_event_t::kind_t::arglist);
 
-  typename std::string::size_type finarg = 1;
+  std::string_view::size_type finarg = 1;
   using avt = argument_t::value_t::type_t;
 
   for (; finarg < chunk.size(); ++finarg) {
     if (!std::isalpha(chunk[finarg]))
-      throw std::runtime_error{"An argument list must only contain letters "
-                               "apart from the starting dash."};
-    if (!concisedb_.contains(chunk[finarg]))
-      throw std::runtime_error{"The character: '" + std::string{chunk[finarg]} +
-                               "' is not a valid concise argument."};
-    auto arg = concisedb_.at(chunk[finarg]);
-    if (tokens_.back().id.size() || tokens_.back().values.size())
-      tokens_.push_back({.id = arg->token, .values = {}});
-    else
-      tokens_.back() = {.id = arg->token, .values = {}};
+      return fail(ctx, lex_error::code_t::bad_arglist_char, finarg);
+    auto id = db_.concise(chunk[finarg]);
+    tally(ctx, [&](auto &c) {
+      ++c.concise_lookups;
+      c.concise_misses += id == no_arg;
+    });
+    if (id == no_arg)
+      return fail(ctx, lex_error::code_t::unknown_concise, finarg);
+    const auto &arg = db_.argument(id);
+    activate(ctx, id, arg.value, finarg);
+    emit(ctx, trace_event_t::kind_t::matched, id);
+    if (detail::has_id(back(ctx).id) || ctx.nvalues)
+      open_token(ctx);
+    set_id(back(ctx), id, arg);
+    if (violates(ctx, id, finarg))
+      return true;
 
-    if (arg->value.type != avt::none)
+    if (arg.value.type != avt::none)
       break;
   }
 
   if (++finarg >= chunk.size()) {
-    if (tokendb_.at(tokens_.back().id)->value.type != avt::none)
-      value_ = true;
+    if (ctx.active.type != avt::none)
+      ctx.value = true;
     return true;
   }
 
-  assign(chunk.substr(finarg, chunk.size() - finarg));
+  assign(ctx, chunk.substr(finarg));
   return true;
 }
 
-template <template <typename, typename...> typename C>
-bool lexer_t<C>::is_longarg(const std::string &chunk) const {
-  if (hyphen_)
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::is_longarg(const context_t &ctx,
+                                  std::string_view chunk) const {
+  if (ctx.hyphen)
     return false;
   if (chunk.size() < 3)
     return false;
@@ -217,119 +1385,518 @@ bool lexer_t<C>::is_longarg(const std::string &chunk) const {
     return false;
   if (chunk[1] != '-')
     return false;
-  if (!std::isalpha(chunk[2]))
-    throw std::runtime_error{
-        "The first character of a verbose argument must be a letter."};
   return true;
 }
 
-template <template <typename, typename...> typename C>
-bool lexer_t<C>::handle_longarg(const std::string &chunk) const {
-  if (!is_longarg(chunk))
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::handle_longarg(context_t &ctx,
+                                      std::string_view chunk) const {
+  if (!is_longarg(ctx, chunk))
     return false;
-  logdbg("Chunk identified as: longarg");
+  if (!std::isalpha(chunk[2]))
+    return fail(ctx, lex_error::code_t::bad_verbose, 2);
+  emit(ctx, trace_event_t::kind_t::longarg);
 
-  std::string vname{chunk.begin() + 2, chunk.end()};
-  typename std::string::size_type eqpos{};
-  eqpos = chunk.find('=');
-  std::string value{};
+  auto vname = chunk.substr(2);
+  auto eqpos = chunk.find('=');
+  std::string_view value{};
 
-  if (eqpos != std::string::npos) {
-    value = chunk.substr(eqpos + 1, chunk.size() - (eqpos + 1));
+  if (eqpos != std::string_view::npos) {
+    value = chunk.substr(eqpos + 1);
     vname = chunk.substr(2, eqpos - 2);
   }
 
-  if (!verbosedb_.contains(vname))
-    throw std::runtime_error{"The specified long arg: '" + vname +
-                             "' is not in the database."};
+  auto id = db_.verbose(vname);
+  tally(ctx, [&](auto &c) {
+    ++c.verbose_lookups;
+    c.verbose_misses += id == no_arg;
+  });
+  if constexpr (requires { db_.abbreviation(vname); }) {
+    if (id == no_arg && abbrev_) {
+      auto match = db_.abbreviation(vname);
+      if (match.count > 1)
+        return fail(ctx, lex_error::code_t::ambiguous_verbose, 2);
+      id = match.id;
+    }
+  }
+  if (id == no_arg)
+    return fail(ctx, lex_error::code_t::unknown_verbose, 2);
 
-  auto desc = verbosedb_.at(vname);
-  tokens_.back().id = desc->token;
+  const auto &desc = db_.argument(id);
+  activate(ctx, id, desc.value, 2);
+  emit(ctx, trace_event_t::kind_t::matched, id);
+  set_id(back(ctx), id, desc);
+  if (violates(ctx, id, 2))
+    return true;
 
   using avt = argument_t::value_t::type_t;
-  if (desc->value.type == avt::none) {
+  if (desc.value.type == avt::none) {
     if (value.size())
-      throw std::runtime_error{"The flag: '" + vname +
-                               "' does not take any parameters."};
+      return fail(ctx, lex_error::code_t::unexpected_value, 2);
     return true;
   }
   if (value.size())
-    assign(value);
+    assign(ctx, value);
   else
-    value_ = true;
+    ctx.value = true;
   return true;
 }
 
-template <template <typename, typename...> typename C>
-bool lexer_t<C>::handle_freearg(const std::string &chunk) const {
-  logdbg("Chunk identified as: freearg");
-  if (!hyphen_ && chunk == "--") {
-    hyphen_ = true;
-    skip_ = true;
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::handle_freearg(context_t &ctx,
+                                      std::string_view chunk) const {
+  emit(ctx, trace_event_t::kind_t::freearg);
+  if (!ctx.hyphen && chunk == "--") {
+    ctx.hyphen = true;
+    ctx.skip = true;
     return true;
   }
-  tokens_.back().values.push_back(chunk);
+  add_value(ctx, chunk);
   return true;
 }
 
-template <template <typename, typename...> typename C>
-void lexer_t<C>::tokenize(const std::string &chunk) const {
-  logdbg("Analyzing chunk: '" + chunk + "'");
-  try {
-    if (handle_value(chunk)) // ... -o value ...
-      return;
-  } catch (const std::exception &e) {
-    throw std::runtime_error{std::string{"Failed handle_value(...): "} +
-                             e.what()};
-  }
-  if (!skip_)
-    tokens_.push_back({});
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::tokenize(context_t &ctx, std::string_view chunk) const {
+  ctx.chunk = chunk;
+  emit(ctx, trace_event_t::kind_t::chunk);
+  tally(ctx, [&](auto &c) { c.bytes += chunk.size(); });
+  if (handle_value(ctx, chunk)) { // ... -o value ...
+    tally(ctx, [](auto &c) { ++c.value_chunks; });
+    return !ctx.failed;
+  }
+  if (!ctx.skip)
+    open_token(ctx);
   else
-    skip_ = false;
+    ctx.skip = false;
+
+  if (handle_arglist(ctx, chunk)) { // ... -abcd ...
+    tally(ctx, [](auto &c) { ++c.arglist_chunks; });
+    return !ctx.failed;
+  }
+  if (handle_longarg(ctx, chunk)) { // ... --arg ...
+    tally(ctx, [](auto &c) { ++c.longarg_chunks; });
+    return !ctx.failed;
+  }
+  handle_freearg(ctx, chunk); // ... freeval ...
+  tally(ctx, [](auto &c) { ++c.freearg_chunks; });
+  return true;
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::feed(context_t &ctx, std::string_view chunk) const {
+  if (!rsp_ || ctx.hyphen || chunk.size() < 2 || chunk.front() != '@')
+    return tokenize(ctx, chunk);
+  return expand(ctx, chunk.substr(1));
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::expand(context_t &ctx, std::string_view path) const {
+  response_file_t file{std::string{path}};
+  if (!file)
+    return !fail(ctx, lex_error::code_t::bad_response, 0);
+  if (std::ranges::find(ctx.files, file.id()) != ctx.files.end())
+    return !fail(ctx, lex_error::code_t::recursive_response, 0);
+
+  ctx.files.push_back(file.id());
+  for (std::string_view chunk{}; file.next(chunk);) {
+    if (!feed(ctx, chunk)) {
+      // The offset refers to a chunk of the file, not of the input.
+      ctx.error.offset = 0;
+      return false;
+    }
+  }
+  ctx.files.pop_back();
+  return true;
+}
 
-  try {
-    if (handle_arglist(chunk)) // ... -abcd ...
-      return;
-  } catch (const std::exception &e) {
-    throw std::runtime_error{std::string{"Failed handle_arglist(...): "} +
-                             e.what()};
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::violates(context_t &ctx, arg_id_t id,
+                                std::string_view::size_type pos) const {
+  if constexpr (requires { db_.slot(id); }) {
+    auto slot = db_.slot(id);
+    if (slot == std::remove_cv_t<D>::npos) [[likely]]
+      return false;
+    if (ctx.seen.empty())
+      ctx.seen.resize(db_.constrained().size());
+    auto &seen = ctx.seen[slot];
+    const auto &c = db_.argument(id).constraints;
+    // Were the argument given before, it would own the bit of its group.
+    if (c.group) {
+      auto bit = std::uint64_t{1} << (c.group - 1);
+      if (!seen.count && (ctx.groups & bit))
+        return fail(ctx, lex_error::code_t::exclusive_argument, pos);
+      ctx.groups |= bit;
+    }
+    if (c.max && seen.count == c.max)
+      return fail(ctx, lex_error::code_t::too_many, pos);
+    if (!seen.count++) {
+      seen.index = ctx.index;
+      seen.offset = ctx.files.empty() ? pos : 0;
+    }
   }
+  return false;
+}
 
-  try {
-    if (handle_longarg(chunk)) // ... --arg ...
-      return;
-  } catch (const std::exception &e) {
-    throw std::runtime_error{std::string{"Failed handle_longarg(...): "} +
-                             e.what()};
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::validate(context_t &ctx) const {
+  // Every value is assigned as soon as its chunk is seen,
+  // so only the last argument can still be waiting for one.
+  if (ctx.value) {
+    ctx.error = {.code = lex_error::code_t::missing_value,
+                 .index = ctx.active_index,
+                 .offset = ctx.active_offset};
+    ctx.failed = true;
+    return false;
+  }
+  // The occurrences were counted on the way, so only the arguments
+  // with constraints are checked here, not the tokens.
+  if constexpr (requires { db_.constrained(); }) {
+    const auto &ids = db_.constrained();
+    const auto count = [&](std::size_t slot) -> std::size_t {
+      return slot < ctx.seen.size() ? ctx.seen[slot].count : 0;
+    };
+    for (std::size_t slot = 0; slot < ids.size(); ++slot) {
+      const auto &c = db_.argument(ids[slot]).constraints;
+      if (count(slot) < std::max<std::size_t>(c.min, c.required)) {
+        ctx.error = {.code = lex_error::code_t::missing_argument,
+                     .index = ctx.index,
+                     .offset = 0,
+                     .arg = ids[slot]};
+        ctx.failed = true;
+        return false;
+      }
+      if (count(slot) && c.depends && !count(db_.slot(c.depends))) {
+        ctx.error = {.code = lex_error::code_t::missing_dependency,
+                     .index = ctx.seen[slot].index,
+                     .offset = ctx.seen[slot].offset,
+                     .arg = c.depends};
+        ctx.failed = true;
+        return false;
+      }
+    }
   }
+  return true;
+}
 
-  try {
-    if (handle_freearg(chunk)) // ... freeval ...
-      return;
-  } catch (const std::exception &e) {
-    throw std::runtime_error{std::string{"Failed handle_freearg(...): "} +
-                             e.what()};
+template <template <typename, typename...> typename C, typename T, typename D>
+lexer_t<C, T, D>::result_t lexer_t<C, T, D>::finish(context_t &ctx) const {
+  bool ok = !ctx.failed && validate(ctx);
+  record(ctx, true);
+  if (!ok)
+    return std::unexpected{ctx.error};
+  seal(ctx);
+  return std::move(ctx.tokens);
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+std::string lexer_t<C, T, D>::message(const lex_error &err,
+                                      std::string_view chunk) const {
+  auto msg = err.message(chunk);
+  if (err.arg != no_arg)
+    msg += " Required: --" + std::string{argument(err.arg).verbose} + ".";
+  if constexpr (requires { db_.candidates(chunk); }) {
+    // Inside a response file the chunk is the @path.
+    if (err.code != lex_error::code_t::ambiguous_verbose ||
+        !chunk.starts_with("--"))
+      return msg;
+    auto vname = chunk.substr(2, chunk.find('=') - 2);
+    std::string list{};
+    for (auto id : db_.candidates(vname))
+      list += (list.empty() ? " Candidates: --" : ", --") +
+              std::string{argument(id).verbose};
+    msg += list + ".";
   }
+  return msg;
 }
 
-template <template <typename, typename...> typename ContainerType>
-lexer_t<ContainerType>::container_t
-lexer_t<ContainerType>::tokenize(const input_t &in, const offset_t &off) const {
-  if (!in.size())
-    return {};
-  if (tokens_.size())
-    tokens_.clear();
+template <template <typename, typename...> typename C, typename T, typename D>
+std::expected<void, lex_error>
+lexer_t<C, T, D>::finish_into(context_t &ctx, container_t &out) const {
+  bool chunk_failed = ctx.failed;
+  bool ok = !chunk_failed && validate(ctx);
+  record(ctx, true);
+  seal(ctx);
+  // Not the token opened for the failing chunk, if nothing was found
+  // in it, e.g. for an unknown --name. The empty token of a final "--"
+  // stays when the constraints fail.
+  if (chunk_failed && ctx.ntokens && ctx.opened == ctx.error.index &&
+      !detail::has_id(back(ctx).id) && !ctx.nvalues) {
+    --ctx.ntokens;
+    ctx.tokens.pop_back();
+  }
+  out = std::move(ctx.tokens);
+  if (!ok)
+    return std::unexpected{ctx.error};
+  return {};
+}
 
-  hyphen_ = false, value_ = false, skip_ = false;
+template <template <typename, typename...> typename C, typename T, typename D>
+lexer_t<C, T, D>::result_t
+lexer_t<C, T, D>::try_tokenize(const input_t &in, const offset_t &off,
+                               const allocator_type &alloc) const {
+  context_t ctx{alloc};
+  for (ctx.index = off; ctx.index < in.size(); ++ctx.index)
+    if (!feed(ctx, std::string_view{in[ctx.index]}))
+      break;
+  return finish(ctx);
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::clean_after(std::string_view chunk,
+                                   const allocator_type &alloc) const {
+  // A "--" may start the hyphen mode, and a response file may hold any
+  // chunk. Otherwise, only an argument still waiting for its value
+  // makes the next chunk a value. Were the chunk itself a value,
+  // or in hyphen mode, the next chunk would not be one either.
+  if (chunk == "--" || (rsp_ && chunk.starts_with('@')))
+    return false;
+  context_t ctx{alloc};
+  return !feed(ctx, chunk) || !ctx.value;
+}
 
-  for (typename input_t::size_type i = off; i < in.size(); ++i)
-    tokenize(in[i]);
+template <template <typename, typename...> typename C, typename T, typename D>
+bool lexer_t<C, T, D>::is_freearg(const context_t &ctx,
+                                  std::string_view chunk) const {
+  if (ctx.value || ctx.hyphen || chunk == "--")
+    return false;
+  if (rsp_ && chunk.size() >= 2 && chunk.front() == '@')
+    return false;
+  return !is_arglist(ctx, chunk) && !is_longarg(ctx, chunk);
+}
 
-  using avt = argument_t::value_t::type_t;
-  for (const auto &t : tokens_)
-    if (t.id.size() && tokendb_.at(t.id)->value.type != avt::none)
-      if (t.values.empty())
-        throw std::runtime_error{"The token: '" + t.id + "' requires a value."};
-  return tokens_;
+template <template <typename, typename...> typename C, typename T, typename D>
+template <typename F>
+lexer_t<C, T, D>::result_t lexer_t<C, T, D>::head(std::size_t n,
+                                                  offset_t &off,
+                                                  F &&chunk) const {
+  context_t ctx{};
+  for (ctx.index = off; ctx.index < n; ++ctx.index)
+    if (is_freearg(ctx, chunk(ctx.index)) || !feed(ctx, chunk(ctx.index)))
+      break;
+  off = ctx.index;
+  return finish(ctx);
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+void lexer_t<C, T, D>::join(context_t &ctx, context_t &next) const {
+  seal(ctx);
+  seal(next);
+  ctx.tokens.insert(ctx.tokens.end(),
+                    std::make_move_iterator(next.tokens.begin()),
+                    std::make_move_iterator(next.tokens.end()));
+  ctx.ntokens += next.ntokens;
+  ctx.nvalues = next.nvalues;
+  ctx.active = next.active;
+  ctx.active_id = next.active_id;
+  ctx.active_index = next.active_index;
+  ctx.active_offset = next.active_offset;
+  ctx.index = next.index;
+  if (next.ntokens)
+    ctx.opened = next.opened;
+  ctx.chunk = next.chunk;
+  ctx.error = next.error;
+  ctx.failed = next.failed;
+  ctx.hyphen = next.hyphen;
+  ctx.value = next.value;
+  ctx.skip = next.skip;
+#if GLEX_STATS
+  ctx.counts += next.counts;
+#endif
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+lexer_t<C, T, D>::result_t
+lexer_t<C, T, D>::try_tokenize_parallel(const input_t &in, const offset_t &off,
+                                        std::size_t nthreads,
+                                        const allocator_type &alloc) const {
+  auto n = in.size() > off ? in.size() - off : 0;
+  if (!nthreads)
+    nthreads = std::max(1u, std::thread::hardware_concurrency());
+  nthreads = std::min(nthreads, n / parallel_grain);
+  if (nthreads < 2 || sink_)
+    return try_tokenize(in, off, alloc);
+  // The occurrences of an argument are counted over the whole input.
+  if constexpr (requires { db_.constrained(); })
+    if (!db_.constrained().empty())
+      return try_tokenize(in, off, alloc);
+
+  // Segment k holds the chunks from bounds[k] up to bounds[k + 1].
+  std::vector<std::size_t> bounds{off};
+  for (std::size_t k = 1; k < nthreads; ++k) {
+    auto b = std::max(bounds.back() + 1, off + n * k / nthreads);
+    while (b < in.size() && !clean_after(in[b - 1], alloc))
+      ++b;
+    if (b < in.size())
+      bounds.push_back(b);
+  }
+  bounds.push_back(in.size());
+
+  std::vector<context_t> segments{};
+  segments.reserve(bounds.size() - 1);
+  for (std::size_t k = 0; k + 1 < bounds.size(); ++k)
+    segments.emplace_back(alloc);
+
+  const auto run = [&](std::size_t k, bool hyphen) {
+    auto &ctx = segments[k];
+    ctx.reset();
+    ctx.hyphen = hyphen;
+    for (ctx.index = bounds[k]; ctx.index < bounds[k + 1]; ++ctx.index)
+      if (!feed(ctx, std::string_view{in[ctx.index]}))
+        break;
+  };
+  // Joined when leaving, also if starting a worker throws.
+  const auto spread = [&](std::size_t first, bool hyphen) {
+    std::vector<std::jthread> workers{};
+    for (auto k = first + 1; k < segments.size(); ++k)
+      workers.emplace_back(run, k, hyphen);
+    run(first, hyphen);
+  };
+
+  // The first segment starts as the input does, and every segment
+  // ends as it would in a single pass if it started so. The hyphen
+  // mode never turns off, so once a segment ends in it,
+  // every following segment is tokenized again in it.
+  spread(0, false);
+  std::size_t k = 1;
+  for (; k < segments.size(); ++k)
+    if (segments[k - 1].failed || segments[k - 1].hyphen)
+      break;
+  if (k < segments.size() && !segments[k - 1].failed)
+    spread(k, true);
+
+  auto &ctx = segments.front();
+  for (k = 1; k < segments.size() && !ctx.failed; ++k)
+    join(ctx, segments[k]);
+  return finish(ctx);
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+arg_id_t lexer_t<C, T, D>::lookup_verbose(std::string_view name) const {
+  auto id = db_.verbose(name);
+  if constexpr (requires { db_.abbreviation(name); })
+    if (id == no_arg && abbrev_)
+      id = db_.abbreviation(name).id;
+  return id;
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+completion_t lexer_t<C, T, D>::complete_value(std::string_view word,
+                                              std::size_t start,
+                                              arg_id_t id) const {
+  completion_t out{.kind = completion_t::kind_t::value, .arg = id};
+  if (id != no_arg)
+    detail::complete_value(out, word, start, argument(id).value);
+  return out;
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+completion_t lexer_t<C, T, D>::complete(const input_t &in, std::size_t cursor,
+                                        const offset_t &off) const {
+  context_t ctx{};
+  cursor = std::min(cursor, in.size());
+  for (ctx.index = off; ctx.index < cursor; ++ctx.index)
+    if (!feed(ctx, std::string_view{in[ctx.index]}))
+      ctx.failed = ctx.value = false;
+
+  using kind = completion_t::kind_t;
+  auto word = cursor < in.size() ? std::string_view{in[cursor]}
+                                 : std::string_view{};
+  if (ctx.value)
+    return complete_value(word, 0, ctx.active_id);
+  if (ctx.hyphen || !word.starts_with('-'))
+    return {.kind = kind::free};
+
+  completion_t out{.kind = kind::argument};
+  const auto verbose = [&](std::string_view prefix) {
+    if constexpr (requires { db_.candidates(prefix); }) {
+      for (auto id : db_.candidates(prefix))
+        out.candidates.push_back("--" + std::string{argument(id).verbose});
+    } else {
+      auto first = out.candidates.size();
+      for (arg_id_t id = 1; id <= db_.size(); ++id)
+        if (std::string_view name = argument(id).verbose;
+            name.starts_with(prefix))
+          out.candidates.push_back("--" + std::string{name});
+      std::sort(out.candidates.begin() + first, out.candidates.end());
+    }
+  };
+
+  if (word.starts_with("--")) {
+    auto eq = word.find('=');
+    if (eq != std::string_view::npos) {
+      auto id = lookup_verbose(word.substr(2, eq - 2));
+      return complete_value(word, eq + 1, id);
+    }
+    verbose(word.substr(2));
+    return out;
+  }
+
+  // A list of concise arguments, up to the first one taking a value.
+  for (std::size_t i = 1; i < word.size(); ++i) {
+    auto id = db_.concise(word[i]);
+    if (id == no_arg)
+      return out;
+    if (argument(id).value.type == argument_t::value_t::type_t::none)
+      continue;
+    if (i + 1 < word.size())
+      return complete_value(word, i + 1 + (word[i + 1] == '='), id);
+    out.candidates.emplace_back(word);
+    return out;
+  }
+  if (word.size() > 1)
+    out.candidates.emplace_back(word);
+  for (char c : std::string_view{"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                 "abcdefghijklmnopqrstuvwxyz"})
+    if (db_.concise(c) != no_arg)
+      out.candidates.push_back(std::string{word} + c);
+  if (word == "-")
+    verbose("");
+  return out;
+}
+
+template <template <typename, typename...> typename C, typename T, typename D>
+std::vector<typename lexer_t<C, T, D>::result_t>
+lexer_t<C, T, D>::tokenize_batch(std::span<const input_t> in,
+                                 std::size_t nthreads) const {
+  std::vector<result_t> out(in.size());
+  const auto run = [&](std::size_t i) { out[i] = try_tokenize(in[i]); };
+
+  if (!nthreads)
+    nthreads = std::max(1u, std::thread::hardware_concurrency());
+  nthreads = std::min(nthreads, in.size());
+  if (nthreads < 2) {
+    for (std::size_t i = 0; i < in.size(); ++i)
+      run(i);
+    return out;
+  }
+
+  // Each worker owns an equal slice of the inputs, and once it is done
+  // steals the remaining inputs of the other slices one at a time.
+  struct alignas(64) slice_t {
+    std::atomic<std::size_t> next;
+    std::size_t end;
+  };
+  std::vector<slice_t> slices(nthreads);
+  for (std::size_t w = 0; w < nthreads; ++w) {
+    slices[w].next = in.size() * w / nthreads;
+    slices[w].end = in.size() * (w + 1) / nthreads;
+  }
+
+  const auto work = [&](std::size_t self) {
+    for (std::size_t k = 0; k < nthreads; ++k) {
+      auto &s = slices[(self + k) % nthreads];
+      for (auto i = s.next++; i < s.end; i = s.next++)
+        run(i);
+    }
+  };
+
+  {
+    // Joined when leaving, also if starting a worker throws.
+    std::vector<std::jthread> workers{};
+    for (std::size_t w = 1; w < nthreads; ++w)
+      workers.emplace_back(work, w);
+    work(0);
+  }
+  return out;
 }
 } // namespace glex
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <gnu-lexer/hash.hpp>
+#include <gnu-lexer/lexer.hpp>
+#include <gnu-lexer/static_database.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace glex {
+/* A read-only copy of a database_t, packed once its last argument
+ * is added, for schemas too large to be efficiently looked up
+ * through node-based maps.
+ *
+ * All the names are stored in one string pool, and the rest of the
+ * arguments in parallel arrays indexed by their ids. Long names are
+ * looked up in an open-addressing table of (hash, id) slots probed
+ * linearly, short names in a table indexed by the character.
+ * The ids are those of the database_t it was built from.
+ *
+ *   glex::database_t db{};
+ *   db.add({...});
+ *   glex::lexer_t<std::vector, glex::token_t, glex::packed_database_t> lex{
+ *       glex::packed_database_t{db}};
+ *
+ * The arrays live in a single image, which save() writes to a file
+ * and load() maps back into memory, so a program can tokenize against
+ * a schema generated at build time (see the glex-schema tool)
+ * without adding a single argument. Copies share the image.
+ */
+class packed_database_t {
+public:
+  using argument_type = static_argument_t;
+
+  packed_database_t() : packed_database_t{database_t{}} {}
+  // Throws a std::runtime_error if db has arguments with constraints.
+  explicit packed_database_t(const database_t &db);
+
+  /* Maps the image saved at path. A missing, truncated or
+   * corrupt file, or one saved by another version or on a machine
+   * of another byte order, throws a std::runtime_error.
+   */
+  static packed_database_t load(const std::string &path);
+  void save(const std::string &path) const;
+
+  arg_id_t verbose(std::string_view name) const noexcept {
+    if (!count_)
+      return no_arg;
+    auto h = hash(name);
+    auto tag = static_cast<std::uint32_t>(h >> 32);
+    for (auto i = h & mask_;; i = (i + 1) & mask_) {
+      auto id = slots_[2 * i + 1];
+      if (id == no_arg)
+        return no_arg;
+      if (slots_[2 * i] == tag && name_of(2 * id - 1) == name)
+        return id;
+    }
+  }
+
+  arg_id_t concise(char c) const noexcept {
+    return concise_[static_cast<unsigned char>(c)];
+  }
+
+  // The names of the returned argument refer to the database.
+  static_argument_t argument(arg_id_t id) const noexcept {
+    using value_t = argument_t::value_t;
+    const char *v = values_ + 4 * (id - 1);
+    return {.token = name_of(2 * id - 2),
+            .verbose = name_of(2 * id - 1),
+            .concise = concises_[id - 1],
+            .value = {.type = static_cast<value_t::type_t>(v[0]),
+                      .delimiter = v[1],
+                      .element = static_cast<value_t::element_t>(v[2])}};
+  }
+
+  std::size_t size() const noexcept { return count_; }
+
+private:
+  /* The image starts with a header of header_words words,
+   * then come the words of the name bounds, of the long name slots
+   * and of the short name table, then the bytes of the value specs,
+   * of the short names and of the pool. All are in native byte order.
+   */
+  static constexpr char magic[8] = {'G', 'L', 'E', 'X', 'P', 'A', 'C', 'K'};
+  static constexpr std::uint32_t version = 2;
+  static constexpr std::uint32_t byte_order = 0x01020304;
+  static constexpr std::size_t header_words = 8;
+
+  using image_t = std::shared_ptr<const std::uint32_t>;
+  struct packed_t {
+    image_t image;
+    std::size_t bytes;
+  };
+
+  static packed_t pack(const database_t &);
+  static std::size_t image_bytes(std::size_t count, std::size_t nslots,
+                                 std::size_t pool);
+  // Checks the image, and points the arrays into it.
+  explicit packed_database_t(packed_t);
+
+  static std::uint64_t hash(std::string_view s) noexcept {
+    return detail::hash(s);
+  }
+
+  // Name 2 * (id - 1) is the token of argument id, the next its verbose.
+  std::string_view name_of(std::size_t n) const noexcept {
+    return {pool_ + bounds_[n], bounds_[n + 1] - bounds_[n]};
+  }
+
+  image_t image_{};
+  std::size_t bytes_{0}; // of the image
+  std::size_t count_{0};
+  std::size_t mask_{0};
+  const std::uint32_t *bounds_{nullptr}; // of the names in the pool
+  const std::uint32_t *slots_{nullptr};  // (hash tag, id) pairs
+  const std::uint32_t *concise_{nullptr};
+  const char *values_{nullptr}; // type, delimiter, element and padding
+  const char *concises_{nullptr};
+  const char *pool_{nullptr};
+};
+} // namespace glex
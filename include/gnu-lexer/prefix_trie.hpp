@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace glex::detail {
+/* Maps the prefixes of the verbose names to the arguments they abbreviate.
+ *
+ * Every node is a character of a name, linked to its first child
+ * and its next sibling, and all the nodes live in a single vector.
+ * A node counts the names passing through it, so a lookup walks
+ * the characters of the prefix once, whatever the number of names.
+ */
+class prefix_trie_t {
+public:
+  using id_t = std::size_t; // an arg_id_t
+  struct match_t {
+    id_t id;           // the name starting with the prefix, if count is 1
+    std::size_t count; // of the names starting with the prefix
+  };
+
+  void insert(std::string_view name, id_t id);
+  void clear() { nodes_.clear(); }
+
+  match_t find(std::string_view prefix) const;
+
+  // The ids of every name starting with the prefix, in name order.
+  std::vector<id_t> candidates(std::string_view prefix) const;
+
+private:
+  static constexpr std::uint32_t none = 0;
+
+  struct node_t {
+    char c;
+    std::uint32_t child{none};
+    std::uint32_t sibling{none};
+    std::uint32_t count{0};
+    id_t id{0};  // the last name passing through the node
+    id_t end{0}; // the name ending at the node
+  };
+
+  std::uint32_t child(std::uint32_t node, char c) const;
+  std::uint32_t walk(std::string_view prefix) const;
+  void collect(std::uint32_t node, std::vector<id_t> &out) const;
+
+  // The root is node 0, so none doubles as "no link".
+  std::vector<node_t> nodes_{};
+};
+} // namespace glex::detail
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace glex {
+/* A response file mapped into memory, e.g. the file.rsp of @file.rsp.
+ *
+ * The chunks are separated by whitespace. Single or double quotes
+ * group whitespace into a chunk, and outside single quotes
+ * a backslash escapes the next character. The quotes and escapes
+ * are removed in place in a private mapping of the file,
+ * so the chunks returned by next() refer to the mapping
+ * and are only valid as long as the response_file_t is.
+ */
+class response_file_t {
+public:
+  // The identity of a file, its device and inode numbers.
+  using id_t = std::pair<unsigned long long, unsigned long long>;
+
+  explicit response_file_t(const std::string &path);
+  ~response_file_t();
+  response_file_t(const response_file_t &) = delete;
+  response_file_t &operator=(const response_file_t &) = delete;
+
+  // Whether the file was opened and mapped.
+  explicit operator bool() const { return ok_; }
+  id_t id() const { return id_; }
+
+  /* Stores the next chunk in chunk, and returns false
+   * once there are no more chunks.
+   */
+  bool next(std::string_view &chunk);
+
+private:
+  char *data_{nullptr};
+  std::size_t size_{0};
+  std::size_t pos_{0};
+  id_t id_{};
+  bool ok_{false};
+};
+} // namespace glex
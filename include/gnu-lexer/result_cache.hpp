@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <gnu-lexer/hash.hpp>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace glex {
+struct cache_stats_t {
+  std::uint64_t hits;
+  std::uint64_t misses;
+  std::size_t size; // of the results held
+};
+} // namespace glex
+
+namespace glex::detail {
+/* A bounded cache of the results of whole inputs, evicting
+ * the least recently used. An input is a range of chunks
+ * convertible to std::string_view, and the offset tokenizing starts at.
+ *
+ * The entries are spread over shards by the hash of their input,
+ * each with its own lock and its share of the capacity, so threads
+ * looking up different inputs rarely wait for each other. The entries
+ * keep their input, so a hash collision is never mistaken for a hit.
+ * A copy is an empty cache of the same capacity. A cache of capacity 0
+ * has no shards, so it allocates nothing until it is resized.
+ */
+template <typename Value> class result_cache_t {
+public:
+  explicit result_cache_t(std::size_t capacity = 0) { resize(capacity); }
+  result_cache_t(const result_cache_t &o) : result_cache_t{o.capacity_} {}
+  result_cache_t &operator=(const result_cache_t &o) {
+    resize(o.capacity_);
+    return *this;
+  }
+
+  // Drops every entry, and the counts. Not safe during lookups.
+  void resize(std::size_t capacity) {
+    capacity_ = capacity;
+    nshards_ = !capacity ? 0 : capacity >= 16 * min_per_shard ? 16 : 1;
+    shards_ = nshards_ ? std::make_unique<shard_t[]>(nshards_) : nullptr;
+    // The first shards take the remainder, so they hold capacity in all.
+    for (std::size_t i = 0; i < nshards_; ++i)
+      shards_[i].capacity = capacity / nshards_ + (i < capacity % nshards_);
+    hits_ = misses_ = 0;
+  }
+  std::size_t capacity() const { return capacity_; }
+
+  // Drops every entry, e.g. once the database changed.
+  void clear() {
+    for (std::size_t i = 0; i < nshards_; ++i) {
+      std::scoped_lock lock{shards_[i].mutex};
+      shards_[i].index.clear();
+      shards_[i].entries.clear();
+    }
+  }
+
+  template <typename R>
+  static std::uint64_t hash(const R &chunks, std::size_t off) {
+    // Every chunk hash starts from the previous one, and mixes in
+    // the size of the chunk, so moving a boundary changes the hash.
+    std::uint64_t h = off;
+    for (const auto &c : chunks)
+      h = detail::hash(std::string_view{c}, h);
+    return h;
+  }
+
+  template <typename R>
+  std::optional<Value> find(std::uint64_t h, const R &chunks,
+                            std::size_t off) {
+    if (!nshards_) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    auto &s = shard(h);
+    std::scoped_lock lock{s.mutex};
+    auto it = s.index.find(h);
+    if (it == s.index.end() || !it->second->matches(chunks, off)) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    // The most recently used entry comes first.
+    s.entries.splice(s.entries.begin(), s.entries, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->value;
+  }
+
+  // Replaces any entry of the same hash, as another thread may add it.
+  template <typename R>
+  void insert(std::uint64_t h, const R &chunks, std::size_t off, Value v) {
+    if (!nshards_)
+      return;
+    auto &s = shard(h);
+    std::vector<std::string> key{};
+    for (const auto &c : chunks)
+      key.emplace_back(std::string_view{c});
+
+    std::scoped_lock lock{s.mutex};
+    if (auto it = s.index.find(h); it != s.index.end()) {
+      s.entries.erase(it->second);
+      s.index.erase(it);
+    } else if (s.entries.size() >= s.capacity) {
+      s.index.erase(s.entries.back().hash);
+      s.entries.pop_back();
+    }
+    s.entries.push_front({h, std::move(key), off, std::move(v)});
+    s.index.emplace(h, s.entries.begin());
+  }
+
+  cache_stats_t stats() const {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < nshards_; ++i) {
+      std::scoped_lock lock{shards_[i].mutex};
+      size += shards_[i].entries.size();
+    }
+    return {.hits = hits_.load(std::memory_order_relaxed),
+            .misses = misses_.load(std::memory_order_relaxed),
+            .size = size};
+  }
+
+private:
+  // Below this, a single shard keeps the eviction order exact.
+  static constexpr std::size_t min_per_shard = 16;
+
+  struct entry_t {
+    std::uint64_t hash;
+    std::vector<std::string> chunks;
+    std::size_t off;
+    Value value;
+
+    template <typename R> bool matches(const R &in, std::size_t o) const {
+      const auto view = [](const auto &c) { return std::string_view{c}; };
+      return o == off && std::ranges::equal(chunks, in, {}, {}, view);
+    }
+  };
+
+  struct shard_t {
+    mutable std::mutex mutex;
+    std::size_t capacity{0};
+    std::list<entry_t> entries; // most recently used first
+    std::unordered_map<std::uint64_t, typename std::list<entry_t>::iterator>
+        index;
+  };
+
+  shard_t &shard(std::uint64_t h) { return shards_[h % nshards_]; }
+
+  std::size_t capacity_{0};
+  std::size_t nshards_{0};
+  std::unique_ptr<shard_t[]> shards_{};
+  std::atomic<std::uint64_t> hits_{0};
+  std::atomic<std::uint64_t> misses_{0};
+};
+} // namespace glex::detail
@@ -0,0 +1,109 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace glex::detail {
+/* The scanners behind split(), each under a name of its own, so that
+ * what they are does not depend on the -m flags of the translation
+ * unit including them. split_avx2() is built for AVX2 whatever the
+ * flags, and must only be called when has_avx2().
+ */
+
+// Calls f with every part from start up to the delimiters from p on.
+template <typename F>
+void split_tail(const char *p, const char *start, const char *end, char d,
+                F &f) {
+  for (; p < end; ++p)
+    if (*p == d) {
+      f(std::string_view{start, p});
+      start = p + 1;
+    }
+  f(std::string_view{start, end});
+}
+
+template <typename F> void split_scalar(std::string_view s, char d, F &&f) {
+  split_tail(s.data(), s.data(), s.data() + s.size(), d, f);
+}
+
+#if defined(__x86_64__)
+// Calls f for the delimiters set in mask, the bytes from base on.
+template <typename F>
+void split_mask(std::uint32_t mask, const char *base, const char *&start,
+                F &f) {
+  for (; mask; mask &= mask - 1) {
+    const char *hit = base + std::countr_zero(mask);
+    f(std::string_view{start, hit});
+    start = hit + 1;
+  }
+}
+
+// Every x86-64 processor has SSE2.
+template <typename F> void split_sse2(std::string_view s, char d, F &&f) {
+  const char *p = s.data();
+  const char *const end = p + s.size();
+  const char *start = p;
+  const __m128i d16 = _mm_set1_epi8(d);
+  for (; end - p >= 16; p += 16) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    split_mask(
+        static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d16))),
+        p, start, f);
+  }
+  split_tail(p, start, end, d, f);
+}
+
+template <typename F>
+[[gnu::target("avx2")]] void split_avx2(std::string_view s, char d, F &&f) {
+  const char *p = s.data();
+  const char *const end = p + s.size();
+  const char *start = p;
+  const __m256i d32 = _mm256_set1_epi8(d);
+  for (; end - p >= 32; p += 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    split_mask(static_cast<std::uint32_t>(
+                   _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, d32))),
+               p, start, f);
+  }
+  const __m128i d16 = _mm_set1_epi8(d);
+  for (; end - p >= 16; p += 16) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    split_mask(
+        static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d16))),
+        p, start, f);
+  }
+  split_tail(p, start, end, d, f);
+}
+
+// Whether the processor running the program has AVX2.
+inline bool has_avx2() {
+  static const bool avx2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return avx2;
+}
+#endif
+
+/* Calls f with every part of s separated by the delimiter d,
+ * including empty parts, in a single pass over s.
+ *
+ * On x86-64 the delimiters are found 32 bytes at a time when the
+ * processor has AVX2, checked once at run time, or else 16 at a time
+ * with SSE2, the tail is scanned byte by byte.
+ */
+template <typename F> void split(std::string_view s, char d, F &&f) {
+#if defined(__x86_64__)
+  if (s.size() >= 32 && has_avx2())
+    split_avx2(s, d, f);
+  else
+    split_sse2(s, d, f);
+#else
+  split_scalar(s, d, f);
+#endif
+}
+} // namespace glex::detail
@@ -0,0 +1,150 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <gnu-lexer/lexer.hpp>
+#include <stdexcept>
+#include <string_view>
+
+namespace glex {
+/* An argument_t whose names are known at compile time. */
+struct static_argument_t {
+  std::string_view token;
+
+  std::string_view verbose; // long argument version e.g. --opt
+  char concise;             // short argument version e.g. -o
+
+  argument_t::value_t value;
+};
+
+/* An argument database built entirely at compile time.
+ *
+ * Invalid or duplicate arguments are rejected during constant evaluation,
+ * so a bad definition fails to compile. Long names are looked up through
+ * a perfect hash (hash and displace), short names through a table indexed
+ * by the character, and neither lookup compares more than one name.
+ *
+ * Use make_database() to create one and pass it to a lexer_t:
+ *
+ *   constexpr auto db = glex::make_database({{...}, {...}});
+ *   glex::lexer_t<std::vector, glex::token_t, decltype(db)> lex{db};
+ */
+template <std::size_t N> class static_database_t {
+  static_assert(N < UINT16_MAX, "Too many arguments for a static database.");
+
+public:
+  using argument_type = static_argument_t;
+
+  consteval explicit static_database_t(const static_argument_t (&args)[N]) {
+    for (std::size_t i = 0; i < N; ++i) {
+      const auto &a = args[i];
+      if (!detail::is_valid(a.token, a.verbose, a.value))
+        throw std::invalid_argument{"The supplied arg is invalid!"};
+      for (std::size_t j = 0; j < i; ++j)
+        if (args[j].token == a.token || args[j].verbose == a.verbose)
+          throw std::invalid_argument{"The supplied arg is a duplicate!"};
+
+      args_[i + 1] = a;
+      if (a.concise) {
+        auto &c = concise_[static_cast<unsigned char>(a.concise)];
+        if (c)
+          throw std::invalid_argument{"The supplied arg is a duplicate!"};
+        c = static_cast<std::uint16_t>(i + 1);
+      }
+    }
+    build_index();
+  }
+
+  constexpr arg_id_t verbose(std::string_view name) const noexcept {
+    auto h = hash(name);
+    auto idx = slots_[slot(h, disp_[h % buckets])];
+    return idx && args_[idx].verbose == name ? idx : no_arg;
+  }
+
+  constexpr arg_id_t concise(char c) const noexcept {
+    return concise_[static_cast<unsigned char>(c)];
+  }
+
+  constexpr const static_argument_t &argument(arg_id_t id) const noexcept {
+    return args_[id];
+  }
+
+  constexpr std::size_t size() const noexcept { return N; }
+  constexpr auto begin() const noexcept { return args_.begin() + 1; }
+  constexpr auto end() const noexcept { return args_.end(); }
+
+private:
+  static constexpr std::size_t buckets = N ? N : 1;
+  static constexpr std::size_t nslots = std::bit_ceil(2 * buckets);
+
+  static constexpr std::uint64_t hash(std::string_view s) noexcept {
+    std::uint64_t h = 0xcbf29ce484222325ull; // FNV-1a
+    for (auto c : s)
+      h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    return h;
+  }
+
+  static constexpr std::size_t slot(std::uint64_t h,
+                                    std::uint32_t d) noexcept {
+    h += d * 0x9e3779b97f4a7c15ull;
+    h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdull;
+    h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53ull;
+    return (h ^ (h >> 33)) & (nslots - 1);
+  }
+
+  // Places the largest buckets first, and searches each bucket
+  // for a displacement that sends all its names to free slots.
+  consteval void build_index() {
+    std::array<std::size_t, buckets> load{};
+    for (std::size_t i = 1; i <= N; ++i)
+      ++load[hash(args_[i].verbose) % buckets];
+
+    for (std::size_t size = N; size > 0; --size) {
+      for (std::size_t b = 0; b < buckets; ++b) {
+        if (load[b] != size)
+          continue;
+        for (std::uint32_t d = 0;; ++d) {
+          if (d == UINT32_MAX)
+            throw std::logic_error{"Failed to build the perfect hash."};
+          if (place(b, d)) {
+            disp_[b] = d;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  consteval bool place(std::size_t bucket, std::uint32_t d) {
+    std::array<std::size_t, N ? N : 1> taken{};
+    std::size_t ntaken = 0;
+    for (std::size_t i = 1; i <= N; ++i) {
+      auto h = hash(args_[i].verbose);
+      if (h % buckets != bucket)
+        continue;
+      auto s = slot(h, d);
+      if (slots_[s]) {
+        for (std::size_t j = 0; j < ntaken; ++j)
+          slots_[taken[j]] = 0;
+        return false;
+      }
+      slots_[s] = static_cast<std::uint16_t>(i);
+      taken[ntaken++] = s;
+    }
+    return true;
+  }
+
+  // Index 0 is unused, so that the indices are the arguments' ids
+  // and no_arg marks an empty slot.
+  std::array<static_argument_t, N + 1> args_{};
+  std::array<std::uint32_t, buckets> disp_{};
+  std::array<std::uint16_t, nslots> slots_{};
+  std::array<std::uint16_t, 256> concise_{};
+};
+
+template <std::size_t N>
+consteval static_database_t<N>
+make_database(const static_argument_t (&args)[N]) {
+  return static_database_t<N>{args};
+}
+} // namespace glex
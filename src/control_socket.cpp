@@ -0,0 +1,242 @@
+#include <cerrno>
+#include <cstring>
+#include <gnu-lexer/control_socket.hpp>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace glex {
+namespace {
+// Reads are done into at least this much free space.
+constexpr std::size_t min_read = 64 * 1024;
+constexpr int max_events = 64;
+
+void append_size(std::string &out, std::size_t n) {
+  for (int i = 0; i < 4; ++i)
+    out.push_back(static_cast<char>(n >> (8 * i) & 0xff));
+}
+
+std::uint32_t read_size(const char *p) {
+  std::uint32_t n = 0;
+  for (int i = 0; i < 4; ++i)
+    n |= std::uint32_t(static_cast<unsigned char>(p[i])) << (8 * i);
+  return n;
+}
+
+[[noreturn]] void fail(const std::string &what) {
+  throw std::runtime_error{"Control socket: " + what + ": " +
+                           std::strerror(errno)};
+}
+} // namespace
+
+void append_frame(std::string &out, std::span<const std::string_view> argv) {
+  std::size_t n = 0;
+  for (auto a : argv)
+    n += a.size() + 1;
+  append_size(out, n);
+  for (auto a : argv) {
+    out += a;
+    out.push_back('\0');
+  }
+}
+
+control_server_t::control_server_t(std::string path, handler_t handler,
+                                   std::size_t max_frame)
+    : path_{std::move(path)}, handler_{std::move(handler)},
+      max_frame_{max_frame} {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path_.size() >= sizeof(addr.sun_path))
+    throw std::runtime_error{"Control socket: the path is too long"};
+  std::memcpy(addr.sun_path, path_.c_str(), path_.size() + 1);
+
+  // A socket left by a previous run is replaced, any other file is not.
+  struct stat st {};
+  if (::lstat(path_.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+    ::unlink(path_.c_str());
+
+  listener_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listener_ < 0)
+    fail("socket");
+  epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+  wakeup_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_ < 0 || wakeup_ < 0) {
+    release();
+    fail("epoll");
+  }
+  if (::bind(listener_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) ||
+      ::listen(listener_, SOMAXCONN)) {
+    // Not ours to remove, e.g. if the path is in use.
+    path_.clear();
+    release();
+    fail("bind");
+  }
+
+  for (int fd : {listener_, wakeup_}) {
+    epoll_event ev{.events = EPOLLIN, .data = {.fd = fd}};
+    ::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev);
+  }
+}
+
+control_server_t::~control_server_t() { release(); }
+
+void control_server_t::release() {
+  for (auto &[fd, c] : connections_)
+    ::close(fd);
+  connections_.clear();
+  for (int fd : {listener_, epoll_, wakeup_})
+    if (fd >= 0)
+      ::close(fd);
+  listener_ = epoll_ = wakeup_ = -1;
+  if (!path_.empty())
+    ::unlink(path_.c_str());
+}
+
+void control_server_t::run() {
+  while (poll(-1))
+    ;
+}
+
+void control_server_t::stop() {
+  stopped_ = true;
+  std::uint64_t one = 1;
+  [[maybe_unused]] auto n = ::write(wakeup_, &one, sizeof(one));
+}
+
+bool control_server_t::poll(int timeout_ms) {
+  if (stopped_)
+    return false;
+  epoll_event events[max_events];
+  int n = ::epoll_wait(epoll_, events, max_events, timeout_ms);
+  for (int i = 0; i < n && !stopped_; ++i) {
+    int fd = events[i].data.fd;
+    if (fd == listener_) {
+      accept();
+      continue;
+    }
+    if (fd == wakeup_)
+      continue;
+    auto it = connections_.find(fd);
+    if (it == connections_.end())
+      continue;
+    auto &c = *it->second;
+    if (events[i].events & (EPOLLERR | EPOLLHUP) &&
+        !(events[i].events & EPOLLIN)) {
+      close(fd);
+      continue;
+    }
+    if (events[i].events & EPOLLOUT) {
+      if (!flush(c))
+        continue;
+    }
+    if (events[i].events & EPOLLIN)
+      receive(c);
+  }
+  return !stopped_;
+}
+
+void control_server_t::accept() {
+  for (;;) {
+    int fd = ::accept4(listener_, nullptr, nullptr,
+                       SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0)
+      return;
+    auto c = std::make_unique<connection_t>(fd);
+    epoll_event ev{.events = EPOLLIN, .data = {.fd = fd}};
+    if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev)) {
+      ::close(fd);
+      continue;
+    }
+    connections_.emplace(fd, std::move(c));
+  }
+}
+
+void control_server_t::receive(connection_t &c) {
+  if (c.in.size() - c.used < min_read)
+    c.in.resize(c.used + min_read);
+  auto n = ::read(c.fd, c.in.data() + c.used, c.in.size() - c.used);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+    close(c.fd);
+    return;
+  }
+  if (n < 0)
+    return;
+  c.used += std::size_t(n);
+
+  // Every complete frame read so far, replied to in order.
+  std::size_t pos = 0;
+  while (c.used - pos >= 4) {
+    auto size = read_size(c.in.data() + pos);
+    if (size > max_frame_) {
+      close(c.fd);
+      return;
+    }
+    if (c.used - pos - 4 < size)
+      break;
+    char *payload = c.in.data() + pos + 4;
+    if (size && payload[size - 1] != '\0') {
+      close(c.fd);
+      return;
+    }
+    argv_.clear();
+    for (std::size_t i = 0; i < size; i += std::strlen(payload + i) + 1)
+      argv_.push_back(payload + i);
+    argv_.push_back(nullptr);
+
+    reply_.clear();
+    handler_(int(argv_.size() - 1), argv_.data(), reply_);
+    append_size(c.out, reply_.size());
+    c.out += reply_;
+    pos += 4 + size;
+  }
+  // The start of an incomplete frame moves to the front.
+  if (pos) {
+    std::memmove(c.in.data(), c.in.data() + pos, c.used - pos);
+    c.used -= pos;
+  }
+  flush(c);
+}
+
+bool control_server_t::flush(connection_t &c) {
+  while (c.sent < c.out.size()) {
+    // Not write(), which raises SIGPIPE once the client closed,
+    // failing with EPIPE instead, which closes the connection below.
+    auto n = ::send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent,
+                    MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 && errno == EAGAIN) {
+      // Only written to, until the replies are out.
+      if (!c.writing) {
+        c.writing = true;
+        epoll_event ev{.events = EPOLLOUT, .data = {.fd = c.fd}};
+        ::epoll_ctl(epoll_, EPOLL_CTL_MOD, c.fd, &ev);
+      }
+      return false;
+    }
+    if (n < 0) {
+      close(c.fd);
+      return false;
+    }
+    c.sent += std::size_t(n);
+  }
+  c.out.clear();
+  c.sent = 0;
+  if (c.writing) {
+    c.writing = false;
+    epoll_event ev{.events = EPOLLIN, .data = {.fd = c.fd}};
+    ::epoll_ctl(epoll_, EPOLL_CTL_MOD, c.fd, &ev);
+  }
+  return true;
+}
+
+void control_server_t::close(int fd) {
+  ::epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+  ::close(fd);
+  connections_.erase(fd);
+}
+} // namespace glex
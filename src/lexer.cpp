@@ -1,23 +1,11 @@
-#include <cctype>
+#include <charconv>
 #include <gnu-lexer/lexer.hpp>
+#include <iostream>
+#include <stdexcept>
 
 namespace glex {
 bool is_valid(const argument_t &arg) {
-  if (!arg.token.size())
-    return false;
-  if (!arg.verbose.size())
-    return false;
-  if (arg.value.type == argument_t::value_t::type_t::multi) {
-    switch (arg.value.delimiter) {
-    case 0:
-    case '-':
-    case ' ':
-      return false;
-    }
-    if (std::isalnum(arg.value.delimiter))
-      return false;
-  }
-  return true;
+  return detail::is_valid(arg.token, arg.verbose, arg.value);
 }
 
 bool contains(const std::list<argument_t> &db, const argument_t &b) {
@@ -33,6 +21,237 @@ bool contains(const std::vector<argument_t> &db, const argument_t &b) {
       return true;
   return false;
 }
+
+bool contains(const std::deque<argument_t> &db, const argument_t &b) {
+  for (const auto &a : db)
+    if (a == b)
+      return true;
+  return false;
+}
+
+arg_id_t database_t::add(argument_t arg) {
+  const auto &c = arg.constraints;
+  // The same check as contains(argdb_, arg), without scanning argdb_.
+  if (!is_valid(arg) || tokendb_.contains(arg.token) ||
+      verbosedb_.contains(arg.verbose) ||
+      (arg.concise && concisedb_.contains(arg.concise)) || c.group > 64 ||
+      (c.max && c.min > c.max) ||
+      c.depends > argdb_.size()) {
+    throw std::runtime_error{"The supplied arg is invalid!"};
+  }
+  argdb_.push_back(std::move(arg));
+  arg_id_t id = argdb_.size();
+  tokendb_.emplace(argdb_.back().token, id);
+  verbosedb_.emplace(argdb_.back().verbose, id);
+  if (argdb_.back().concise)
+    concisedb_.emplace(argdb_.back().concise, id);
+  prefixes_.insert(argdb_.back().verbose, id);
+
+  slots_.push_back(npos);
+  const auto constrain = [&](arg_id_t i) {
+    if (slots_[i - 1] == npos) {
+      slots_[i - 1] = constrained_.size();
+      constrained_.push_back(i);
+    }
+  };
+  const auto &added = argdb_.back().constraints;
+  if (added.depends)
+    constrain(added.depends);
+  if (added.required || added.min || added.max || added.group ||
+      added.depends)
+    constrain(id);
+  return id;
+}
+
+std::string lex_error::message(std::string_view chunk) const {
+  // The name of the argument at offset, e.g. 'opt' in --opt=v or 'o' in -ao.
+  std::string name{};
+  if (code == code_t::bad_value && offset <= chunk.size() &&
+      !chunk.starts_with('@')) {
+    // The value at offset, up to a delimiter, e.g. 'x' in --ids=1,x,3.
+    const auto in_value = [](char c) {
+      return std::isalnum(static_cast<unsigned char>(c)) || c == '+' ||
+             c == '-' || c == '.';
+    };
+    auto end = offset;
+    while (end < chunk.size() && in_value(chunk[end]))
+      ++end;
+    name = ": '" + std::string{chunk.substr(offset, end - offset)} + "'";
+  } else if (offset < chunk.size() && !chunk.starts_with('@')) {
+    if (chunk.starts_with("--"))
+      name = chunk.substr(offset, chunk.find('=') - offset);
+    else
+      name = chunk.substr(offset, 1);
+    name = ": '" + name + "'";
+  }
+
+  if (code == code_t::unknown_command)
+    name = ": '" + std::string{chunk} + "'";
+
+  std::string file{};
+  if (chunk.starts_with('@'))
+    file = ": '" + std::string{chunk.substr(1)} + "'";
+
+  std::string msg{};
+  using enum code_t;
+  switch (code) {
+  case short_chunk:
+    msg = "Hyphen mode is not active, and the current chunk is not supposed "
+          "to be a value, so the chunk must be at least 2 characters long.";
+    break;
+  case empty_value:
+    msg = "An assigned value cannot be empty.";
+    break;
+  case bad_arglist_char:
+    msg = "An argument list must only contain letters "
+          "apart from the starting dash.";
+    break;
+  case unknown_concise:
+    msg = "The character" + name + " is not a valid concise argument.";
+    break;
+  case bad_verbose:
+    msg = "The first character of a verbose argument must be a letter.";
+    break;
+  case unknown_verbose:
+    msg = "The specified long arg" + name + " is not in the database.";
+    break;
+  case unexpected_value:
+    msg = "The flag" + name + " does not take any parameters.";
+    break;
+  case missing_value:
+    msg = "The argument" + name + " requires a value.";
+    break;
+  case bad_response:
+    msg = "The response file" + file + " could not be read.";
+    break;
+  case recursive_response:
+    msg = "The response file" + file +
+          " includes itself, directly or through another response file.";
+    break;
+  case bad_value:
+    msg = "The value" + name + " is not valid for its argument.";
+    break;
+  case ambiguous_verbose:
+    msg = "The long arg" + name + " is ambiguous, it abbreviates "
+          "several arguments.";
+    break;
+  case missing_argument:
+    msg = "A required argument is missing, or given too few times.";
+    break;
+  case too_many:
+    msg = "The argument" + name + " is given too many times.";
+    break;
+  case exclusive_argument:
+    msg = "The argument" + name +
+          " cannot be combined with another argument of its group.";
+    break;
+  case missing_dependency:
+    msg = "The argument" + name + " requires another argument.";
+    break;
+  case unknown_command:
+    msg = "The command" + name + " is not known.";
+    break;
+  }
+  return msg + " (chunk " + std::to_string(index) + ", offset " +
+         std::to_string(offset) + ")";
+}
+
+namespace detail {
+bool decode(std::string_view s, argument_t::value_t::element_t e,
+            scalar_t &out) {
+  const auto parse = [&]<typename N>(N n) {
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), n);
+    if (ec != std::errc{} || end != s.data() + s.size())
+      return false;
+    out = n;
+    return true;
+  };
+
+  using enum argument_t::value_t::element_t;
+  switch (e) {
+  case string:
+    return false;
+  case int64:
+    return parse(std::int64_t{});
+  case uint64:
+    return parse(std::uint64_t{});
+  case real:
+    return parse(double{});
+  case boolean:
+    for (std::string_view t : {"true", "yes", "on", "1"})
+      if (s == t) {
+        out = true;
+        return true;
+      }
+    for (std::string_view f : {"false", "no", "off", "0"})
+      if (s == f) {
+        out = false;
+        return true;
+      }
+    return false;
+  }
+  return false;
+}
+
+void complete_value(completion_t &out, std::string_view word,
+                    std::size_t start, const argument_t::value_t &value) {
+  if (value.element != argument_t::value_t::element_t::boolean)
+    return;
+  // Only the last value of a list is completed.
+  auto begin = start;
+  if (value.type == argument_t::value_t::type_t::multi)
+    if (auto d = word.rfind(value.delimiter); d != word.npos && d >= start)
+      begin = d + 1;
+  auto prefix = word.substr(0, begin);
+  for (std::string_view name : {"false", "no", "off", "on", "true", "yes"})
+    if (name.starts_with(word.substr(begin)))
+      out.candidates.push_back(std::string{prefix} + std::string{name});
+}
+} // namespace detail
+
+namespace {
+struct stdout_trace_t : trace_sink_t {
+  void event(const trace_event_t &e) override {
+    using enum trace_event_t::kind_t;
+    switch (e.kind) {
+    case chunk:
+      std::cout << "DBG: Analyzing chunk " << e.index << ": '" << e.chunk
+                << "'\n";
+      return;
+    case value:
+      std::cout << "DBG: Chunk identified as: value\n";
+      return;
+    case arglist:
+      std::cout << "DBG: Chunk identified as: arglist\n";
+      return;
+    case longarg:
+      std::cout << "DBG: Chunk identified as: longarg\n";
+      return;
+    case freearg:
+      std::cout << "DBG: Chunk identified as: freearg\n";
+      return;
+    case matched:
+      std::cout << "DBG: Matched argument id: " << e.arg << "\n";
+      return;
+    }
+  }
+};
+} // namespace
+
+trace_sink_t &stdout_trace() {
+  static stdout_trace_t sink{};
+  return sink;
+}
+
+void database_t::clear() {
+  argdb_.clear();
+  tokendb_.clear();
+  verbosedb_.clear();
+  concisedb_.clear();
+  prefixes_.clear();
+  constrained_.clear();
+  slots_.clear();
+}
 } // namespace glex
 
 bool operator==(const glex::argument_t &a, const glex::argument_t &b) {
@@ -0,0 +1,170 @@
+#include <bit>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <gnu-lexer/packed_database.hpp>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace glex {
+std::size_t packed_database_t::image_bytes(std::size_t count,
+                                           std::size_t nslots,
+                                           std::size_t pool) {
+  auto words = header_words + (2 * count + 1) + 2 * nslots + 256;
+  return 4 * words + 5 * count + pool;
+}
+
+packed_database_t::packed_database_t(const database_t &db)
+    : packed_database_t{pack(db)} {}
+
+packed_database_t::packed_t packed_database_t::pack(const database_t &db) {
+  // Not dropped silently, as the packed lookups cannot enforce them.
+  if (!db.constrained().empty())
+    throw std::runtime_error{
+        "A database with constraints cannot be packed."};
+  const std::size_t count = db.size();
+  if (count >= UINT32_MAX / 4)
+    throw std::runtime_error{"Too many arguments for a packed database."};
+
+  std::size_t length = 0;
+  for (arg_id_t id = 1; id <= count; ++id)
+    length += db.argument(id).token.size() + db.argument(id).verbose.size();
+  if (length >= UINT32_MAX)
+    throw std::runtime_error{"The argument names are too long to pack."};
+
+  // At most half full, so that a miss ends after a short probe.
+  const std::size_t nslots = count ? std::bit_ceil(2 * count) : 0;
+  const auto bytes = image_bytes(count, nslots, length);
+  // Zeroed, so the slots and the short name table start out free.
+  auto words = std::make_shared<std::uint32_t[]>((bytes + 3) / 4);
+
+  auto *header = words.get();
+  std::memcpy(header, magic, sizeof magic);
+  header[2] = version;
+  header[3] = byte_order;
+  header[4] = static_cast<std::uint32_t>(count);
+  header[5] = static_cast<std::uint32_t>(nslots);
+  header[6] = static_cast<std::uint32_t>(length);
+
+  auto *bounds = header + header_words;
+  auto *slots = bounds + 2 * count + 1;
+  auto *table = slots + 2 * nslots;
+  auto *values = reinterpret_cast<char *>(table + 256);
+  auto *concises = values + 4 * count;
+  auto *pool = concises + count;
+
+  std::uint32_t end = 0;
+  const auto store = [&](std::string_view name) {
+    std::memcpy(pool + end, name.data(), name.size());
+    end += static_cast<std::uint32_t>(name.size());
+    *++bounds = end;
+  };
+  for (arg_id_t id = 1; id <= count; ++id) {
+    const auto &arg = db.argument(id);
+    store(arg.token);
+    store(arg.verbose);
+    auto *value = values + 4 * (id - 1);
+    value[0] = static_cast<char>(arg.value.type);
+    value[1] = arg.value.delimiter;
+    value[2] = static_cast<char>(arg.value.element);
+    concises[id - 1] = arg.concise;
+    if (arg.concise)
+      table[static_cast<unsigned char>(arg.concise)] =
+          static_cast<std::uint32_t>(id);
+
+    auto h = hash(arg.verbose);
+    auto i = h & (nslots - 1);
+    while (slots[2 * i + 1] != no_arg)
+      i = (i + 1) & (nslots - 1);
+    slots[2 * i] = static_cast<std::uint32_t>(h >> 32);
+    slots[2 * i + 1] = static_cast<std::uint32_t>(id);
+  }
+  return {.image = image_t{words, words.get()}, .bytes = bytes};
+}
+
+packed_database_t::packed_database_t(packed_t p)
+    : image_{std::move(p.image)}, bytes_{p.bytes} {
+  const auto invalid = [] {
+    throw std::runtime_error{"The packed database is invalid!"};
+  };
+
+  const auto *header = image_.get();
+  if (bytes_ < 4 * header_words || std::memcmp(header, magic, sizeof magic))
+    invalid();
+  if (header[2] != version || header[3] != byte_order)
+    throw std::runtime_error{"The packed database was saved by another "
+                             "version or on another byte order!"};
+
+  count_ = header[4];
+  const std::size_t nslots = header[5];
+  const std::size_t pool = header[6];
+  if (count_ >= UINT32_MAX / 4 ||
+      nslots != (count_ ? std::bit_ceil(2 * count_) : 0) ||
+      bytes_ != image_bytes(count_, nslots, pool))
+    invalid();
+  mask_ = nslots - 1;
+
+  bounds_ = header + header_words;
+  slots_ = bounds_ + 2 * count_ + 1;
+  concise_ = slots_ + 2 * nslots;
+  values_ = reinterpret_cast<const char *>(concise_ + 256);
+  concises_ = values_ + 4 * count_;
+  pool_ = concises_ + count_;
+
+  // Every lookup stays inside the image, and every probe ends.
+  if (bounds_[0] != 0 || bounds_[2 * count_] != pool)
+    invalid();
+  for (std::size_t i = 0; i < 2 * count_; ++i)
+    if (bounds_[i] > bounds_[i + 1])
+      invalid();
+  std::size_t used = 0;
+  for (std::size_t i = 0; i < nslots; ++i)
+    if (auto id = slots_[2 * i + 1]; id > count_ || (id && ++used > count_))
+      invalid();
+  if (used != count_)
+    invalid();
+  for (std::size_t c = 0; c < 256; ++c)
+    if (concise_[c] > count_)
+      invalid();
+  using value_t = argument_t::value_t;
+  for (std::size_t i = 0; i < count_; ++i)
+    if (static_cast<unsigned char>(values_[4 * i]) >
+            static_cast<unsigned char>(value_t::type_t::multi) ||
+        static_cast<unsigned char>(values_[4 * i + 2]) >
+            static_cast<unsigned char>(value_t::element_t::boolean))
+      invalid();
+}
+
+packed_database_t packed_database_t::load(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw std::runtime_error{"The packed database could not be opened!"};
+
+  struct stat st {};
+  void *p = MAP_FAILED;
+  std::size_t size = 0;
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    size = static_cast<std::size_t>(st.st_size);
+    p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (p == MAP_FAILED)
+    throw std::runtime_error{"The packed database could not be mapped!"};
+
+  image_t image{static_cast<const std::uint32_t *>(p),
+                [size](const std::uint32_t *data) {
+                  ::munmap(const_cast<std::uint32_t *>(data), size);
+                }};
+  return packed_database_t{packed_t{.image = std::move(image), .bytes = size}};
+}
+
+void packed_database_t::save(const std::string &path) const {
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out.write(reinterpret_cast<const char *>(image_.get()),
+            static_cast<std::streamsize>(bytes_));
+  if (!out.flush())
+    throw std::runtime_error{"The packed database could not be saved!"};
+}
+} // namespace glex
@@ -0,0 +1,71 @@
+#include <gnu-lexer/prefix_trie.hpp>
+
+namespace glex::detail {
+std::uint32_t prefix_trie_t::child(std::uint32_t node, char c) const {
+  auto n = nodes_[node].child;
+  while (n != none && nodes_[n].c < c)
+    n = nodes_[n].sibling;
+  return n != none && nodes_[n].c == c ? n : none;
+}
+
+std::uint32_t prefix_trie_t::walk(std::string_view prefix) const {
+  if (nodes_.empty())
+    return none;
+  std::uint32_t node = 0;
+  for (char c : prefix)
+    if ((node = child(node, c)) == none)
+      break;
+  return node;
+}
+
+void prefix_trie_t::insert(std::string_view name, id_t id) {
+  if (nodes_.empty())
+    nodes_.push_back({.c = '\0'});
+
+  std::uint32_t node = 0;
+  for (char c : name) {
+    ++nodes_[node].count;
+    nodes_[node].id = id;
+
+    // The siblings are kept sorted, so the candidates come out in order.
+    std::uint32_t prev = none, n = nodes_[node].child;
+    for (; n != none && nodes_[n].c < c; n = nodes_[n].sibling)
+      prev = n;
+    if (n == none || nodes_[n].c != c) {
+      auto added = std::uint32_t(nodes_.size());
+      nodes_.push_back({.c = c, .sibling = n});
+      (prev == none ? nodes_[node].child : nodes_[prev].sibling) = added;
+      n = added;
+    }
+    node = n;
+  }
+  ++nodes_[node].count;
+  nodes_[node].id = id;
+  nodes_[node].end = id;
+}
+
+prefix_trie_t::match_t prefix_trie_t::find(std::string_view prefix) const {
+  auto node = walk(prefix);
+  if (nodes_.empty() || (node == none && !prefix.empty()))
+    return {.id = 0, .count = 0};
+  const auto &n = nodes_[node];
+  return {.id = n.count == 1 ? n.id : 0, .count = n.count};
+}
+
+std::vector<prefix_trie_t::id_t>
+prefix_trie_t::candidates(std::string_view prefix) const {
+  std::vector<id_t> out{};
+  auto node = walk(prefix);
+  if (!nodes_.empty() && (node != none || prefix.empty()))
+    collect(node, out);
+  return out;
+}
+
+void prefix_trie_t::collect(std::uint32_t node,
+                            std::vector<id_t> &out) const {
+  if (nodes_[node].end)
+    out.push_back(nodes_[node].end);
+  for (auto n = nodes_[node].child; n != none; n = nodes_[n].sibling)
+    collect(n, out);
+}
+} // namespace glex::detail
@@ -0,0 +1,71 @@
+#include <cctype>
+#include <fcntl.h>
+#include <gnu-lexer/response_file.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace glex {
+response_file_t::response_file_t(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return;
+
+  struct stat st {};
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+    id_ = {st.st_dev, st.st_ino};
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (!size_) {
+      ok_ = true;
+    } else {
+      // A private writable mapping, so that the quotes and escapes
+      // can be removed in place without touching the file.
+      void *p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       fd, 0);
+      if (p != MAP_FAILED) {
+        data_ = static_cast<char *>(p);
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        ok_ = true;
+      }
+    }
+  }
+  ::close(fd);
+}
+
+response_file_t::~response_file_t() {
+  if (data_)
+    ::munmap(data_, size_);
+}
+
+bool response_file_t::next(std::string_view &chunk) {
+  while (pos_ < size_ && std::isspace(static_cast<unsigned char>(data_[pos_])))
+    ++pos_;
+  if (pos_ >= size_)
+    return false;
+
+  char *begin = data_ + pos_;
+  char *out = begin;
+  char quote = 0;
+  for (; pos_ < size_; ++pos_) {
+    char c = data_[pos_];
+    if (quote) {
+      if (c == quote) {
+        quote = 0;
+        continue;
+      }
+      if (c == '\\' && quote == '"' && pos_ + 1 < size_)
+        c = data_[++pos_];
+    } else if (std::isspace(static_cast<unsigned char>(c))) {
+      break;
+    } else if (c == '\'' || c == '"') {
+      quote = c;
+      continue;
+    } else if (c == '\\' && pos_ + 1 < size_) {
+      c = data_[++pos_];
+    }
+    *out++ = c;
+  }
+  chunk = {begin, static_cast<std::size_t>(out - begin)};
+  return true;
+}
+} // namespace glex
@@ -0,0 +1,105 @@
+#include <bit>
+#include <cmath>
+#include <gnu-lexer/lexer.hpp>
+
+namespace glex {
+namespace {
+// The fields of counts_t stored in counters_t, in order.
+constexpr std::uint64_t counts_t::*fields[] = {
+    &counts_t::calls,           &counts_t::bytes,
+    &counts_t::value_chunks,    &counts_t::arglist_chunks,
+    &counts_t::longarg_chunks,  &counts_t::freearg_chunks,
+    &counts_t::verbose_lookups, &counts_t::verbose_misses,
+    &counts_t::concise_lookups, &counts_t::concise_misses,
+    &counts_t::values_split,
+};
+
+constexpr std::size_t sub_buckets = std::size_t{1}
+                                    << latency_histogram_t::sub_bits;
+} // namespace
+
+counts_t &counts_t::operator+=(const counts_t &o) {
+  for (auto f : fields)
+    this->*f += o.*f;
+  for (std::size_t i = 0; i < nerrors; ++i)
+    errors[i] += o.errors[i];
+  return *this;
+}
+
+std::size_t latency_histogram_t::bucket(std::uint64_t ns) {
+  if (ns < sub_buckets)
+    return ns;
+  // The power of two, then the sub_bits bits following the leading one.
+  std::size_t e = std::bit_width(ns) - 1;
+  return ((e - sub_bits + 1) << sub_bits) +
+         ((ns >> (e - sub_bits)) & (sub_buckets - 1));
+}
+
+std::uint64_t latency_histogram_t::lowest(std::size_t b) {
+  if (b < sub_buckets)
+    return b;
+  std::size_t e = (b >> sub_bits) + sub_bits - 1;
+  return (sub_buckets + (b & (sub_buckets - 1))) << (e - sub_bits);
+}
+
+std::uint64_t latency_histogram_t::highest(std::size_t b) {
+  return b + 1 < nbuckets ? lowest(b + 1) - 1 : UINT64_MAX;
+}
+
+std::uint64_t latency_histogram_t::total() const {
+  std::uint64_t n = 0;
+  for (auto c : counts)
+    n += c;
+  return n;
+}
+
+std::uint64_t latency_histogram_t::percentile(double p) const {
+  auto n = total();
+  if (!n)
+    return 0;
+  auto rank = std::max<std::uint64_t>(1, std::ceil(p * n));
+  std::uint64_t seen = 0;
+  for (std::size_t b = 0; b < nbuckets; ++b)
+    if ((seen += counts[b]) >= rank)
+      return highest(b);
+  return highest(nbuckets - 1);
+}
+
+namespace detail {
+void counters_t::add(const counts_t &c) {
+  static_assert(std::size(fields) == nfields);
+  // Most counts of a call are 0, and skipping them saves the atomics.
+  for (std::size_t i = 0; i < nfields; ++i)
+    if (auto n = c.*fields[i])
+      fields_[i].fetch_add(n, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < counts_t::nerrors; ++i)
+    if (c.errors[i])
+      errors_[i].fetch_add(c.errors[i], std::memory_order_relaxed);
+}
+
+void counters_t::record(std::uint64_t ns) {
+  latency_[latency_histogram_t::bucket(ns)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+stats_t counters_t::snapshot() const {
+  stats_t s{};
+  for (std::size_t i = 0; i < nfields; ++i)
+    s.counts.*fields[i] = fields_[i].load(std::memory_order_relaxed);
+  for (std::size_t i = 0; i < counts_t::nerrors; ++i)
+    s.counts.errors[i] = errors_[i].load(std::memory_order_relaxed);
+  for (std::size_t i = 0; i < latency_histogram_t::nbuckets; ++i)
+    s.latency.counts[i] = latency_[i].load(std::memory_order_relaxed);
+  return s;
+}
+
+void counters_t::reset() {
+  for (auto &c : fields_)
+    c.store(0, std::memory_order_relaxed);
+  for (auto &c : errors_)
+    c.store(0, std::memory_order_relaxed);
+  for (auto &c : latency_)
+    c.store(0, std::memory_order_relaxed);
+}
+} // namespace detail
+} // namespace glex
@@ -0,0 +1,86 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, and checks the unique-prefix matching
+// of verbose arguments: unique prefixes, exact matches shadowing
+// longer names, ambiguous prefixes and the opt-in switch.
+
+namespace {
+using lexer_t = glex::lexer_t<std::vector>;
+} // namespace
+
+int main() {
+  using avt = glex::argument_t::value_t::type_t;
+  using code = glex::lex_error::code_t;
+  std::size_t check{0};
+
+  lexer_t lex{};
+  lex.add({.token = "verb", .verbose = "verbose", .concise = 'v', .value = {}});
+  lex.add({.token = "vers", .verbose = "version", .concise = 'V', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "pro", .verbose = "pro", .concise = 0, .value = {}});
+
+  try {
+    // Off by default.
+    auto r = lex.try_tokenize({"--verb"});
+    if (++check; r || r.error().code != code::unknown_verbose)
+      return err(check);
+
+    lex.abbreviations(true);
+    if (++check; !lex.abbreviations())
+      return err(check);
+
+    r = lex.try_tokenize({"--verb", "--vers", "--prof=x", "--profi", "y"});
+    if (++check; !r || r->size() != 4)
+      return err(check);
+    if (++check; r->at(0).id != "verb" || r->at(1).id != "vers")
+      return err(check);
+    if (++check; r->at(2).id != "prof" || r->at(2).values.front() != "x")
+      return err(check);
+    if (++check; r->at(3).id != "prof" || r->at(3).values.front() != "y")
+      return err(check);
+
+    // An exact match wins over the longer names it prefixes.
+    r = lex.try_tokenize({"--pro"});
+    if (++check; !r || r->size() != 1 || r->front().id != "pro")
+      return err(check);
+
+    r = lex.try_tokenize({"--verbose", "--ver"});
+    if (++check; r || r.error().code != code::ambiguous_verbose ||
+                 r.error().index != 1 || r.error().offset != 2)
+      return err(check);
+
+    r = lex.try_tokenize({"--verbx"});
+    if (++check; r || r.error().code != code::unknown_verbose)
+      return err(check);
+
+    // The candidates are listed in name order.
+    if (++check; lex.database().candidates("v") !=
+                 std::vector<glex::arg_id_t>{1, 2})
+      return err(check);
+
+    try {
+      lex.tokenize({"--v=1"});
+      return err(++check);
+    } catch (const std::runtime_error &e) {
+      std::string msg = e.what();
+      if (++check; msg.find("Candidates: --verbose, --version.") ==
+                   std::string::npos)
+        return err(check);
+    }
+
+    lex.clear();
+    lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+    r = lex.try_tokenize({"--he", "--ver"});
+    if (++check; r || r.error().code != code::unknown_verbose ||
+                 r.error().index != 1)
+      return err(check);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return err(++check, "Unexpected exception at check ");
+  }
+}
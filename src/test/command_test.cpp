@@ -0,0 +1,163 @@
+#include "test_util.hpp"
+#include <atomic>
+#include <gnu-lexer/command.hpp>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+// This test takes no input, and checks that a command_t dispatches
+// on the first free value to its subcommands, building each of them
+// only once it is first selected, even under many threads.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using code = glex::lex_error::code_t;
+using command_t = glex::command_t<std::vector>;
+using input_t = command_t::input_t;
+
+// The names of the commands on the path, and their number of tokens.
+bool path(const command_t::result_t &r,
+          const std::vector<std::pair<std::string, std::size_t>> &expected) {
+  if (!r || r->size() != expected.size())
+    return false;
+  for (std::size_t i = 0; i < expected.size(); ++i)
+    if ((*r)[i].name != expected[i].first ||
+        (*r)[i].tokens.size() != expected[i].second)
+      return false;
+  return true;
+}
+
+bool fails(const command_t::result_t &r, code c, std::size_t index) {
+  return !r && r.error().code == c && r.error().index == index;
+}
+
+std::atomic<std::size_t> builds{0};
+} // namespace
+
+int main() {
+  std::size_t check = 0;
+  command_t nodectrl{};
+  auto &top = nodectrl.lexer();
+  top.add({.token = "verbose", .verbose = "verbose", .concise = 'v',
+           .value = {}});
+  top.add({.token = "conf",
+           .verbose = "config",
+           .concise = 'c',
+           .value = {.type = avt::single}});
+
+  nodectrl.subcommand("start", [](command_t &start) {
+    ++builds;
+    start.lexer().add({.token = "nodes",
+                       .verbose = "list",
+                       .concise = 'l',
+                       .value = {.type = avt::multi, .delimiter = ','},
+                       .constraints = {.required = true}});
+  });
+  nodectrl.subcommand("status", [](command_t &status) {
+    ++builds;
+    status.lexer().add(
+        {.token = "all", .verbose = "all", .concise = 'a', .value = {}});
+  });
+  nodectrl.subcommand("node", [](command_t &node) {
+    ++builds;
+    node.subcommand("stop", [](command_t &stop) {
+      ++builds;
+      stop.lexer().add(
+          {.token = "force", .verbose = "force", .concise = 'f', .value = {}});
+    });
+  });
+
+  // Nothing is built before a subcommand is selected.
+  if (++check; builds || !path(nodectrl.try_tokenize({"-v", "-c", "start"}),
+                               {{"", 2}}))
+    return err(check);
+
+  auto r = nodectrl.try_tokenize({"-vc", "f", "start", "-l1,2", "n3"});
+  if (++check; !path(r, {{"", 2}, {"start", 2}}) || builds != 1)
+    return err(check);
+  if (++check; (*r)[1].tokens[0].id != "nodes" ||
+               (*r)[1].tokens[1].values != std::vector<std::string>{"n3"})
+    return err(check);
+
+  // Selected again, a subcommand is not built again.
+  if (++check; !path(nodectrl.try_tokenize({"start", "--list=a"}),
+                     {{"", 0}, {"start", 1}}) ||
+               builds != 1)
+    return err(check);
+
+  // Nested subcommands, and the errors of every level.
+  if (++check; !path(nodectrl.try_tokenize({"node", "stop", "-f", "now"}),
+                     {{"", 0}, {"node", 0}, {"stop", 2}}) ||
+               builds != 3)
+    return err(check);
+  if (++check; !fails(nodectrl.try_tokenize({"-v", "stop"}),
+                      code::unknown_command, 1) ||
+               !fails(nodectrl.try_tokenize({"node", "-f"}),
+                      code::unknown_concise, 1) ||
+               !fails(nodectrl.try_tokenize({"start", "-a"}),
+                      code::unknown_concise, 1) ||
+               !fails(nodectrl.try_tokenize({"start"}), code::missing_argument,
+                      1))
+    return err(check);
+
+  // A "--" ends the arguments, and what follows is not a subcommand.
+  if (++check; !path(nodectrl.try_tokenize({"-v", "--", "start"}), {{"", 2}}))
+    return err(check);
+
+  // The messages come from the lexer of the failing command.
+  try {
+    nodectrl.tokenize({"-v", "start"});
+    return err(++check);
+  } catch (const std::runtime_error &e) {
+    if (++check; !std::string_view{e.what()}.ends_with("Required: --list."))
+      return err(check);
+  }
+  try {
+    nodectrl.tokenize({"stat"});
+    return err(++check);
+  } catch (const std::runtime_error &e) {
+    if (++check; !std::string_view{e.what()}.contains("'stat'"))
+      return err(check);
+  }
+
+  // From argv, skipping the program name.
+  char prog[] = "nodectrl", status[] = "status", all[] = "--all";
+  char *argv[] = {prog, status, all};
+  if (++check; nodectrl.tokenize(3, argv).back().tokens.size() != 1 ||
+               builds != 4)
+    return err(check);
+
+  // A subcommand selected by many threads at once is built once.
+  command_t cmd{};
+  cmd.subcommand("run", [](command_t &run) {
+    ++builds;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    run.lexer().add(
+        {.token = "fast", .verbose = "fast", .concise = 'f', .value = {}});
+  });
+  std::atomic<std::size_t> mismatches{0};
+  std::vector<std::thread> threads{};
+  for (std::size_t t = 0; t < 8; ++t)
+    threads.emplace_back([&] {
+      if (!path(cmd.try_tokenize({"run", "-f"}), {{"", 0}, {"run", 1}}))
+        ++mismatches;
+    });
+  for (auto &t : threads)
+    t.join();
+  if (++check; mismatches || builds != 5)
+    return err(check);
+
+  // A build that throws is tried again.
+  bool fail = true;
+  cmd.subcommand("flaky", [&](command_t &) {
+    if (std::exchange(fail, false))
+      throw std::runtime_error{"not yet"};
+  });
+  try {
+    cmd.try_tokenize({"flaky"});
+    return err(++check);
+  } catch (const std::runtime_error &) {
+  }
+  if (++check; !path(cmd.try_tokenize({"flaky"}), {{"", 0}, {"flaky", 0}}))
+    return err(check);
+}
@@ -0,0 +1,120 @@
+#include "test_util.hpp"
+#include <gnu-lexer/static_database.hpp>
+#include <iostream>
+
+// This test takes no input, and checks what complete() offers
+// for the word at the cursor: verbose arguments by prefix, lists
+// of concise arguments, boolean values, and nothing for free values.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using elt = glex::argument_t::value_t::element_t;
+using kind = glex::completion_t::kind_t;
+using words = std::vector<std::string>;
+
+bool is(const glex::completion_t &c, kind k, const words &w = {}) {
+  return c.kind == k && c.candidates == w;
+}
+
+template <typename Lexer> void populate(Lexer &lex) {
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+  lex.add({.token = "flags",
+           .verbose = "flags",
+           .concise = 'F',
+           .value = {.type = avt::multi,
+                     .delimiter = ':',
+                     .element = elt::boolean}});
+  lex.add({.token = "verbose",
+           .verbose = "verbose",
+           .concise = 'v',
+           .value = {.type = avt::single, .element = elt::boolean}});
+  lex.add(
+      {.token = "version", .verbose = "version", .concise = 0, .value = {}});
+}
+} // namespace
+
+int main() {
+  std::size_t check = 0;
+  glex::lexer_t<std::vector> lex{};
+  populate(lex);
+
+  // Verbose arguments, in order.
+  if (++check; !is(lex.complete({"--ve"}, 0), kind::argument,
+                   {"--verbose", "--version"}))
+    return err(check);
+  if (++check; !is(lex.complete({"--help", "--f"}, 1), kind::argument,
+                   {"--files", "--flags"}))
+    return err(check);
+  if (++check; !is(lex.complete({"--x"}, 0), kind::argument))
+    return err(check);
+
+  // Values, by a separate chunk, after = or in a list of concise arguments.
+  auto c = lex.complete({"-p"}, 1);
+  if (++check; !is(c, kind::value) || c.arg != 2)
+    return err(check);
+  if (++check; !is(lex.complete({"--verbose=t"}, 0), kind::value,
+                   {"--verbose=true"}))
+    return err(check);
+  if (++check; !is(lex.complete({"--flags", "yes:o"}, 1), kind::value,
+                   {"yes:off", "yes:on"}))
+    return err(check);
+  if (++check; !is(lex.complete({"-hvn"}, 0), kind::value, {"-hvno"}))
+    return err(check);
+  if (++check; !is(lex.complete({"-v", ""}, 1), kind::value,
+                   {"false", "no", "off", "on", "true", "yes"}))
+    return err(check);
+  // A value of a chunk that looks like an argument.
+  if (++check; !is(lex.complete({"--profile", "--he"}, 1), kind::value))
+    return err(check);
+
+  // Concise arguments, and every argument after a single dash.
+  if (++check; !is(lex.complete({"-h"}, 0), kind::argument,
+                   {"-h", "-hF", "-hf", "-hh", "-hp", "-hv"}))
+    return err(check);
+  if (++check; !is(lex.complete({"-hp"}, 0), kind::argument, {"-hp"}))
+    return err(check);
+  if (++check; !is(lex.complete({"-"}, 0), kind::argument,
+                   {"-F", "-f", "-h", "-p", "-v", "--files", "--flags",
+                    "--help", "--profile", "--verbose", "--version"}))
+    return err(check);
+
+  // Free values, also after a "--", and an empty word.
+  if (++check; !is(lex.complete({"--", "-h"}, 1), kind::free) ||
+               !is(lex.complete({"src"}, 0), kind::free) ||
+               !is(lex.complete({"--help"}, 1), kind::free))
+    return err(check);
+
+  // Malformed chunks before the cursor are skipped.
+  if (++check; !is(lex.complete({"-x", "--pro"}, 1), kind::argument,
+                   {"--profile"}))
+    return err(check);
+
+  // An abbreviation names the argument taking the value.
+  lex.abbreviations(true);
+  c = lex.complete({"--prof", "x"}, 1);
+  if (++check; !is(c, kind::value) || c.arg != 2)
+    return err(check);
+  if (++check; !is(lex.complete({"--verb=o"}, 0), kind::value,
+                   {"--verb=off", "--verb=on"}))
+    return err(check);
+
+  // A database without a trie is searched in full.
+  constexpr auto db = glex::make_database(
+      {{.token = "help", .verbose = "help", .concise = 'h', .value = {}},
+       {.token = "hist", .verbose = "history", .concise = 0, .value = {}},
+       {.token = "all", .verbose = "all", .concise = 'a', .value = {}}});
+  glex::lexer_t<std::vector, glex::token_t, decltype(db)> slex{db};
+  if (++check; !is(slex.complete({"--h"}, 0), kind::argument,
+                   {"--help", "--history"}) ||
+               !is(slex.complete({"-"}, 0), kind::argument,
+                   {"-a", "-h", "--all", "--help", "--history"}))
+    return err(check);
+}
@@ -0,0 +1,86 @@
+#include "test_util.hpp"
+#include <atomic>
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+#include <thread>
+
+// This test takes no input, and tokenizes with a single lexer
+// from many threads at once, both by hand and through tokenize_batch,
+// checking every result against the single threaded one.
+// Build with ENABLE_TSAN to have ThreadSanitizer report any data race.
+
+namespace {
+constexpr std::size_t nthreads = 8;
+constexpr std::size_t iterations = 2000;
+
+using lexer_t = glex::lexer_t<std::vector>;
+} // namespace
+
+int main() {
+  using avt = glex::argument_t::value_t::type_t;
+  lexer_t lex{};
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "extr", .verbose = "extract", .concise = 'e', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+
+  const std::vector<lexer_t::input_t> inputs = {
+      {"--help", "-ep/path/to/prof", "-f=f1,f2,f3", "--", "--val"},
+      {"--files", "a,b,", "-hf", "c", "free"},
+      {"--profile=x", "-he", "-p", "y", "--extract"},
+      {"--profile"}, // fails, a value is required
+      {"-x"},        // fails, not in the database
+  };
+
+  const auto run = [&](const lexer_t::input_t &in) {
+    try {
+      return lex.tokenize(in);
+    } catch (const std::exception &) {
+      return lexer_t::container_t{{.id = "error", .values = {}}};
+    }
+  };
+
+  std::vector<lexer_t::container_t> expected{};
+  for (const auto &in : inputs)
+    expected.push_back(run(in));
+
+  std::atomic<std::size_t> mismatches{0};
+  std::vector<std::thread> threads{};
+  for (std::size_t t = 0; t < nthreads; ++t)
+    threads.emplace_back([&, t] {
+      for (std::size_t i = 0; i < iterations; ++i) {
+        auto idx = (i + t) % inputs.size();
+        if (!equal(run(inputs[idx]), expected[idx]))
+          ++mismatches;
+      }
+    });
+  for (auto &t : threads)
+    t.join();
+
+  if (mismatches) {
+    std::cerr << "Mismatched results: " << mismatches << std::endl;
+    return 1;
+  }
+
+  std::vector<lexer_t::input_t> batch{};
+  for (std::size_t i = 0; i < iterations; ++i)
+    batch.push_back(inputs[i % inputs.size()]);
+  auto results = lex.tokenize_batch(batch, nthreads);
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    const auto &r = results[i];
+    const auto &e = expected[i % inputs.size()];
+    if (r ? !equal(*r, e) : e.front().id != "error")
+      ++mismatches;
+  }
+
+  if (mismatches) {
+    std::cerr << "Mismatched batch results: " << mismatches << std::endl;
+    return 1;
+  }
+}
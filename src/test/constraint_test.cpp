@@ -0,0 +1,144 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that the constraints of
+// the arguments are enforced while tokenizing: required arguments,
+// min and max occurrences, exclusive groups and dependencies.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using code = glex::lex_error::code_t;
+using lexer_t = glex::lexer_t<std::vector>;
+using input_t = lexer_t::input_t;
+
+bool fails(const lexer_t &lex, const input_t &in, code c, std::size_t index,
+           std::size_t offset, glex::arg_id_t arg = glex::no_arg) {
+  auto r = lex.try_tokenize(in);
+  return !r && r.error().code == c && r.error().index == index &&
+         r.error().offset == offset && r.error().arg == arg;
+}
+} // namespace
+
+int main() {
+  std::size_t check = 0;
+  lexer_t lex{};
+  auto out = lex.add({.token = "out",
+                      .verbose = "output",
+                      .concise = 'o',
+                      .value = {.type = avt::single},
+                      .constraints = {.required = true, .max = 1}});
+  auto json = lex.add({.token = "json",
+                       .verbose = "json",
+                       .concise = 'j',
+                       .value = {},
+                       .constraints = {.group = 1}});
+  lex.add({.token = "yaml",
+           .verbose = "yaml",
+           .concise = 'y',
+           .value = {},
+           .constraints = {.group = 1}});
+  lex.add({.token = "inc",
+           .verbose = "include",
+           .concise = 'I',
+           .value = {.type = avt::single},
+           .constraints = {.min = 2, .max = 3}});
+  lex.add({.token = "pretty",
+           .verbose = "pretty",
+           .concise = 'p',
+           .value = {},
+           .constraints = {.depends = json}});
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+
+  const input_t base = {"-o", "f", "-Ia", "--include=b"};
+  if (++check; !lex.try_tokenize(base))
+    return err(check);
+
+  // Required, and at least min times, checked at the end of the input.
+  if (++check; !fails(lex, {"-Ia", "-Ib", "-h"}, code::missing_argument, 3, 0,
+                      out) ||
+               !fails(lex, {"-o", "f", "-Ia"}, code::missing_argument, 3, 0,
+                      4) ||
+               !fails(lex, {}, code::missing_argument, 0, 0, out))
+    return err(check);
+
+  // At most max times, failing at the extra occurrence.
+  if (++check; !fails(lex, {"-Ia", "-hof", "-Ib", "--output", "g"},
+                      code::too_many, 3, 2))
+    return err(check);
+  auto in = base;
+  in.insert(in.end(), {"-Ic", "-hId"});
+  if (++check; !fails(lex, in, code::too_many, 5, 2))
+    return err(check);
+
+  // A single argument of a group, given any number of times.
+  in = base;
+  in.insert(in.end(), {"--json", "-j", "-hy"});
+  if (++check; !fails(lex, in, code::exclusive_argument, 6, 2))
+    return err(check);
+  in = base;
+  in.insert(in.end(), {"--yaml", "-y"});
+  if (++check; !lex.try_tokenize(in))
+    return err(check);
+
+  // A dependency, given before or after, or missing.
+  in = base;
+  in.insert(in.end(), {"-hp", "-j"});
+  if (++check; !lex.try_tokenize(in))
+    return err(check);
+  in = base;
+  in.insert(in.end(), {"-y", "--pretty", "-hp"});
+  if (++check; !fails(lex, in, code::missing_dependency, 5, 2, json))
+    return err(check);
+
+  // The messages name the missing arguments.
+  try {
+    lex.tokenize({"-Ia", "-Ib"});
+    return err(++check);
+  } catch (const std::exception &e) {
+    if (++check; !std::string_view{e.what()}.ends_with("Required: --output."))
+      return err(check);
+  }
+
+  // The tokens before are kept, with the empty one of a final "--".
+  lexer_t::container_t tokens{};
+  auto r = lex.try_tokenize_into(tokens, {"-Ia", "-Ib", "--"});
+  if (++check; r || r.error().code != code::missing_argument ||
+               tokens.size() != 3 || !tokens.back().id.empty() ||
+               !tokens.back().values.empty())
+    return err(check);
+
+  // A stream checks them once it is finished.
+  auto stream = lex.stream();
+  const auto ignore = [](auto &&) {};
+  for (std::string_view c : {"-j", "--pretty", "-Ia", "-Ib"})
+    stream.push(c, ignore);
+  try {
+    stream.finish(ignore);
+    return err(++check);
+  } catch (const std::exception &e) {
+    if (++check; !std::string_view{e.what()}.contains("--output"))
+      return err(check);
+  }
+
+  // Invalid constraints are rejected.
+  for (auto c : {glex::argument_t::constraints_t{.group = 65},
+                 glex::argument_t::constraints_t{.min = 3, .max = 2},
+                 glex::argument_t::constraints_t{.depends = 100}}) {
+    try {
+      lex.add({.token = "bad",
+               .verbose = "bad",
+               .concise = 0,
+               .value = {},
+               .constraints = c});
+      return err(++check);
+    } catch (const std::runtime_error &) {
+      ++check;
+    }
+  }
+
+  // A database without constraints has nothing to check.
+  lex.clear();
+  if (++check; !lex.try_tokenize({}) || !lex.database().constrained().empty())
+    return err(check);
+}
@@ -0,0 +1,183 @@
+#include "test_util.hpp"
+#include <gnu-lexer/control_socket.hpp>
+#include <iostream>
+#include <optional>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+// This test takes no input, and checks that a control_server_t
+// answers every frame sent over its socket in order, including frames
+// sent together or a byte at a time, closes the connections
+// sending malformed frames, and survives clients leaving before
+// reading their replies.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using lexer_t = glex::lexer_t<std::vector, glex::token_view_t>;
+using words = std::vector<std::string_view>;
+
+int connect(const std::string &path) {
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool send(int fd, std::string_view data) {
+  while (!data.empty()) {
+    auto n = ::write(fd, data.data(), data.size());
+    if (n <= 0)
+      return false;
+    data.remove_prefix(std::size_t(n));
+  }
+  return true;
+}
+
+// The next reply, or nothing once the server closed the connection.
+std::optional<std::string> reply(int fd) {
+  const auto read_all = [&](char *p, std::size_t n) {
+    while (n) {
+      auto r = ::read(fd, p, n);
+      if (r <= 0)
+        return false;
+      p += r;
+      n -= std::size_t(r);
+    }
+    return true;
+  };
+  unsigned char size[4];
+  if (!read_all(reinterpret_cast<char *>(size), 4))
+    return std::nullopt;
+  std::string out(size[0] | size[1] << 8 | size[2] << 16 | size[3] << 24, 0);
+  if (!read_all(out.data(), out.size()))
+    return std::nullopt;
+  return out;
+}
+
+std::string frame(const words &argv) {
+  std::string out{};
+  glex::append_frame(out, argv);
+  return out;
+}
+} // namespace
+
+int main() {
+  std::size_t check = 0;
+  lexer_t lex{};
+  lex.add({.token = "start", .verbose = "start", .concise = 's', .value = {}});
+  lex.add({.token = "nodes",
+           .verbose = "list",
+           .concise = 'l',
+           .value = {.type = avt::multi, .delimiter = ','}});
+
+  // The reply lists the tokens, or holds the error message.
+  auto path = "/tmp/glex-control-test-" + std::to_string(::getpid());
+  auto server = glex::serve(
+      lex, path,
+      [&](std::span<char *const> argv, const auto &status, const auto &tokens,
+          std::string &out) {
+        if (!status) {
+          auto i = status.error().index;
+          out = "error: ";
+          out += lex.message(status.error(), i < argv.size() ? argv[i] : "");
+          return;
+        }
+        for (const auto &t : tokens) {
+          out += t.id.empty() ? "free" : t.id;
+          for (auto v : t.values) {
+            out += ' ';
+            out += v;
+          }
+          out += ";";
+        }
+      },
+      64);
+  std::thread thread{[&] { server.run(); }};
+
+  int fd = connect(path);
+  if (++check; fd < 0)
+    return err(check);
+
+  // One frame at a time.
+  if (++check; !send(fd, frame({"nodectrl", "-s", "--list", "a,b"})) ||
+               reply(fd) != "start;nodes a b;")
+    return err(check);
+
+  // Frames sent together are answered in order, also an empty one
+  // and one holding only the program name.
+  auto frames = frame({"nodectrl", "-sl1,2"}) + frame({}) +
+                frame({"nodectrl"}) + frame({"nodectrl", "-x"}) +
+                frame({"nodectrl", "free"});
+  if (++check; !send(fd, frames) || reply(fd) != "start;nodes 1 2;" ||
+               reply(fd) != "" || reply(fd) != "" ||
+               !reply(fd)->starts_with("error: The character: 'x'") ||
+               reply(fd) != "free free;")
+    return err(check);
+
+  // A frame split over many writes.
+  auto split = frame({"nodectrl", "--list=x,y", "-s"});
+  for (char c : split)
+    if (++check; !send(fd, std::string_view{&c, 1}))
+      return err(check);
+  if (++check; reply(fd) != "nodes x y;start;")
+    return err(check);
+
+  // A second connection is served alongside the first.
+  int other = connect(path);
+  if (++check; !send(other, frame({"p", "-s"})) || reply(other) != "start;" ||
+               !send(fd, frame({"p", "free"})) || reply(fd) != "free free;")
+    return err(check);
+
+  // A frame larger than the maximum, or not ending in a NUL,
+  // closes its connection.
+  std::string big(100, 'a');
+  if (++check; !send(fd, frame({"p", big})) || reply(fd))
+    return err(check);
+  if (++check; !send(other, std::string{"\3\0\0\0abc", 7}) || reply(other))
+    return err(check);
+  ::close(fd);
+  ::close(other);
+
+  // run() returns once stopped.
+  server.stop();
+  thread.join();
+
+  // A client closing with replies pending only closes its connection,
+  // the replies are written to a closed socket rather than raise
+  // SIGPIPE. Polled here, so that the frames are read after the close.
+  auto quiet = glex::serve(
+      lex, path + "-quiet",
+      [](auto, const auto &, const auto &, std::string &out) {
+        out.assign(1024, 'r');
+      });
+  fd = connect(quiet.path());
+  quiet.poll(1000);
+  if (++check; fd < 0 || quiet.connections() != 1)
+    return err(check);
+  frames.clear();
+  for (int i = 0; i < 64; ++i)
+    frames += frame({"nodectrl", "-s"});
+  if (++check; !send(fd, frames))
+    return err(check);
+  ::close(fd);
+  for (int i = 0; i < 100 && quiet.connections(); ++i)
+    quiet.poll(100);
+  if (++check; quiet.connections())
+    return err(check);
+  // And the server goes on serving.
+  fd = connect(quiet.path());
+  quiet.poll(1000);
+  if (++check; fd < 0 || !send(fd, frame({"p"})))
+    return err(check);
+  quiet.poll(1000);
+  if (++check; reply(fd) != std::string(1024, 'r'))
+    return err(check);
+  ::close(fd);
+}
@@ -0,0 +1,117 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that the lazy tokens have
+// the same values as the tokens split while tokenizing, that size()
+// and front() agree with the iteration, and that the values of
+// lazy_token_view_t refer to the input.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using elt = glex::argument_t::value_t::element_t;
+using input_t = std::vector<std::string>;
+
+template <typename Lexer> void populate(Lexer &lex) {
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+  lex.add({.token = "ids",
+           .verbose = "ids",
+           .concise = 'i',
+           .value = {.type = avt::multi,
+                     .delimiter = ':',
+                     .element = elt::int64}});
+}
+
+template <typename Eager, typename Lazy>
+bool same(const Eager &eager, const Lazy &lazy) {
+  if (eager.size() != lazy.size())
+    return false;
+  for (std::size_t i = 0; i < eager.size(); ++i) {
+    const auto &e = eager[i];
+    const auto &l = lazy[i];
+    auto values = l.values.template to<std::vector<std::string>>();
+    if (e.id != l.id || e.values != values || e.scalars != l.scalars ||
+        l.values.size() != values.size() ||
+        l.values.empty() != values.empty() ||
+        (!values.empty() && l.values.front() != values.front()))
+      return false;
+  }
+  return true;
+}
+} // namespace
+
+int main() {
+  std::size_t check = 0;
+  glex::lexer_t<std::vector> eager{};
+  glex::lexer_t<std::vector, glex::lazy_token_t> lazy{};
+  glex::lexer_t<std::vector, glex::lazy_token_view_t> view{};
+  populate(eager);
+  populate(lazy);
+  populate(view);
+
+  const std::vector<input_t> inputs = {
+      {"--files", "a,b,c"},
+      {"-f", "a,,b"},
+      {"-f=,a"},
+      {"--files=a,b,"},
+      {"-hf", ","},
+      {"-f", ",,"},
+      {"--files", "single"},
+      {"-p", "a,b", "free"},
+      {"--profile=x", "--", "--files", ""},
+      {"-i", "1:-2:3", "-hf", "x,y"},
+      {"free", "values", "-h"},
+      {},
+  };
+  for (const auto &in : inputs) {
+    auto e = eager.tokenize(in);
+    if (++check; !same(e, lazy.tokenize(in)) || !same(e, view.tokenize(in)))
+      return err(check);
+  }
+
+  // Reused tokens, with fewer and more values than before.
+  glex::lexer_t<std::vector, glex::lazy_token_t>::container_t out{};
+  for (const auto &in : inputs) {
+    lazy.tokenize_into(out, in);
+    if (++check; !same(eager.tokenize(in), out))
+      return err(check);
+  }
+
+  // A stream hands over the same tokens.
+  for (const auto &in : inputs) {
+    std::vector<glex::lazy_token_t> streamed{};
+    auto stream = lazy.stream();
+    const auto keep = [&](glex::lazy_token_t &&t) {
+      streamed.push_back(std::move(t));
+    };
+    for (const auto &c : in)
+      stream.push(c, keep);
+    stream.finish(keep);
+    if (++check; !same(eager.tokenize(in), streamed))
+      return err(check);
+  }
+
+  // The raw value is kept, and the values view it.
+  const input_t in = {"--files", "first,second,third"};
+  auto t = view.tokenize(in);
+  const auto &values = t[0].values;
+  if (++check; values.raw().data() != in[1].data() ||
+               values.delimiter() != ',' || values.size() != 3 ||
+               values.front() != "first" ||
+               (*std::next(values.begin(), 2)).data() != in[1].data() + 13)
+    return err(check);
+
+  // The values are a forward range.
+  static_assert(std::ranges::forward_range<glex::lazy_values_t<std::string>>);
+  if (++check; !std::ranges::equal(values, std::vector<std::string_view>{
+                                               "first", "second", "third"}))
+    return err(check);
+}
@@ -0,0 +1,109 @@
+#include "test_util.hpp"
+#include <gnu-lexer/packed_database.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that a packed_database_t
+// resolves every argument of the database_t it was built from,
+// and tokenizes like it.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+} // namespace
+
+int main() {
+  std::size_t check{0};
+
+  glex::database_t db{};
+  db.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  db.add({.token = "prof",
+          .verbose = "profile",
+          .concise = 'p',
+          .value = {.type = avt::single}});
+  db.add({.token = "file",
+          .verbose = "files",
+          .concise = 'f',
+          .value = {.type = avt::multi, .delimiter = ','}});
+  // Enough arguments for the index to collide.
+  for (int i = 0; i < 5000; ++i)
+    db.add({.token = "token" + std::to_string(i),
+            .verbose = "option" + std::to_string(i),
+            .concise = 0,
+            .value = {.type = i % 2 ? avt::single : avt::none}});
+
+  const glex::packed_database_t packed{db};
+  if (++check; packed.size() != db.size())
+    return err(check);
+
+  // One check for all the ids, their number would wrap the exit status.
+  ++check;
+  for (glex::arg_id_t id = 1; id <= db.size(); ++id) {
+    const auto &a = db.argument(id);
+    auto p = packed.argument(id);
+    if (packed.verbose(a.verbose) != id || p.token != a.token ||
+        p.verbose != a.verbose || p.concise != a.concise ||
+        p.value.type != a.value.type ||
+        p.value.delimiter != a.value.delimiter ||
+        (a.concise && packed.concise(a.concise) != id))
+      return err(check);
+  }
+
+  for (std::string_view name : {"", "hel", "helpx", "option5000", "token1"})
+    if (++check; packed.verbose(name) != glex::no_arg)
+      return err(check);
+  for (char c : {'\0', 'x', 'H'})
+    if (++check; packed.concise(c) != glex::no_arg)
+      return err(check);
+
+  const glex::packed_database_t empty{glex::database_t{}};
+  if (++check; empty.size() || empty.verbose("help") || empty.concise('h'))
+    return err(check);
+
+  // The constraints could not be enforced once packed.
+  glex::database_t constrained{};
+  constrained.add({.token = "start",
+                   .verbose = "start",
+                   .concise = 's',
+                   .value = {},
+                   .constraints = {.required = true}});
+  try {
+    glex::packed_database_t p{constrained};
+    return err(++check);
+  } catch (const std::runtime_error &) {
+    ++check;
+  }
+
+  glex::lexer_t<std::vector> lex{db};
+  glex::lexer_t<std::vector, glex::token_t, glex::packed_database_t> plex{
+      packed};
+  glex::lexer_t<std::vector, glex::token_id_t, glex::packed_database_t> ilex{
+      packed};
+
+  const std::vector<glex::lexer_t<std::vector>::input_t> inputs = {
+      {"--help", "-pf", "a,b,c", "--", "--help"},
+      {"--option1=x", "--option4998", "--option4999", "y", "free"},
+      {"-hp/path", "--files=f1,f2,", "--profile", "v"},
+  };
+
+  try {
+    for (const auto &in : inputs) {
+      auto expected = lex.tokenize(in);
+      if (++check; !equal(plex.tokenize(in), expected))
+        return err(check);
+      auto ids = ilex.tokenize(in);
+      if (++check; ids.size() != expected.size())
+        return err(check);
+      for (std::size_t i = 0; i < ids.size(); ++i)
+        if (++check; ids[i].id ? ilex.name(ids[i].id) != expected[i].id
+                               : !expected[i].id.empty())
+          return err(check);
+    }
+
+    using code = glex::lex_error::code_t;
+    auto r = plex.try_tokenize({"--nope"});
+    if (++check; r || r.error().code != code::unknown_verbose)
+      return err(check);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return err(++check, "Unexpected exception at check ");
+  }
+}
@@ -0,0 +1,101 @@
+#include "test_util.hpp"
+#include <cstdio>
+#include <fstream>
+#include <gnu-lexer/packed_database.hpp>
+#include <iostream>
+
+// This test takes the image packed from schema.def at build time,
+// and checks that it maps back to the same arguments and tokenizes
+// like them, that a saved image loads back, and that bad images throw.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using lexer_t =
+    glex::lexer_t<std::vector, glex::token_view_t, glex::packed_database_t>;
+
+bool throws(const std::string &path) {
+  try {
+    glex::packed_database_t::load(path);
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::size_t check{0};
+  if (argc != 2)
+    return err(check, "Usage: packed-image-test <image>, check ");
+
+  try {
+    auto db = glex::packed_database_t::load(argv[1]);
+    if (++check; db.size() != 7)
+      return err(check);
+    if (++check; db.verbose("profile") != 2 || db.concise('f') != 3)
+      return err(check);
+    auto list = db.argument(db.verbose("list"));
+    if (++check; list.token != "list" || list.concise ||
+                 list.value.type != avt::multi || list.value.delimiter != ':')
+      return err(check);
+    if (++check; db.verbose("verb") || db.concise('v'))
+      return err(check);
+    if (++check; db.argument(6).value.element !=
+                 glex::argument_t::value_t::element_t::uint64)
+      return err(check);
+    auto extract = db.argument(7);
+    if (++check; extract.verbose != "extract" || extract.concise ||
+                 extract.value.delimiter || db.concise('0'))
+      return err(check);
+
+    const lexer_t lex{db};
+    lexer_t::input_t in{"-hp",       "/path",  "--list=a:b",
+                        "--verbose", "free", "--port=8080"};
+    auto tokens = lex.tokenize(in);
+    if (++check; tokens.size() != 6 || tokens[1].id != "prof" ||
+                 tokens[2].values.size() != 2 || tokens[3].id != "verb" ||
+                 tokens[4].values.front() != "free")
+      return err(check);
+    if (++check; tokens[5].scalars.size() != 1 ||
+                 std::get<std::uint64_t>(tokens[5].scalars[0]) != 8080)
+      return err(check);
+
+    // Saving and loading again gives the same image.
+    const std::string copy = std::string{argv[1]} + ".copy";
+    db.save(copy);
+    auto again = glex::packed_database_t::load(copy);
+    if (++check; again.size() != db.size() || again.verbose("files") != 3)
+      return err(check);
+
+    glex::database_t runtime{};
+    runtime.add(
+        {.token = "a", .verbose = "alpha", .concise = 'a', .value = {}});
+    glex::packed_database_t{runtime}.save(copy);
+    if (++check; glex::packed_database_t::load(copy).verbose("alpha") != 1)
+      return err(check);
+
+    // Truncated, and with a corrupt name bound.
+    std::string bytes{};
+    {
+      std::ifstream f{copy, std::ios::binary};
+      bytes.assign(std::istreambuf_iterator<char>{f}, {});
+    }
+    std::ofstream{copy, std::ios::binary}.write(bytes.data(),
+                                                bytes.size() - 1);
+    if (++check; !throws(copy))
+      return err(check);
+    bytes[32 + 4] = '\x7f';
+    std::ofstream{copy, std::ios::binary}.write(bytes.data(), bytes.size());
+    if (++check; !throws(copy))
+      return err(check);
+    std::ofstream{copy, std::ios::binary}.write("GLEXPACK", 8);
+    if (++check; !throws(copy))
+      return err(check);
+    std::remove(copy.c_str());
+    if (++check; !throws(copy))
+      return err(check);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return err(++check, "Unexpected exception at check ");
+  }
+}
@@ -0,0 +1,133 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+#include <random>
+
+// This test takes no input, and checks that try_tokenize_parallel()
+// returns the same tokens, or the same error, as try_tokenize()
+// for large random inputs mixing values, "--" and malformed chunks,
+// and for several thread counts and token containers.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using elt = glex::argument_t::value_t::element_t;
+
+template <typename R> bool same(const R &a, const R &b) {
+  if (!a || !b)
+    return !a && !b && a.error().code == b.error().code &&
+           a.error().index == b.error().index &&
+           a.error().offset == b.error().offset;
+  return equal(*a, *b);
+}
+
+template <typename Lexer> void populate(Lexer &lex) {
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "extr", .verbose = "extract", .concise = 'e', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+  lex.add({.token = "port",
+           .verbose = "port",
+           .concise = 'n',
+           .value = {.type = avt::single, .element = elt::uint64}});
+}
+
+// Chunks taking a value are frequent, so that runs of them
+// often cross the segment bounds.
+// Only the malformed chunks fail, as a port is given with its value.
+const std::vector<std::string> words = {
+    "-h",      "-p",     "-p",          "-hp",         "-pvalue",
+    "--files", "-f",     "-hf",         "a,b,c",       "xy",
+    "-e",      "--help", "--port=8080", "--files=q,r", "-n1",
+    "-ehp",    "--",     "/a/path/",    "-f=,a,",      "--extract",
+    "free",    "--profile",
+};
+const std::vector<std::string> malformed = {"-x", "--nope", "-1", "--port=x",
+                                            "--help=y", "-p="};
+
+template <typename Lexer>
+std::size_t run(const Lexer &lex, std::mt19937 &rng, std::size_t &check) {
+  using input_t = typename Lexer::input_t;
+  std::uniform_int_distribution<std::size_t> word(0, words.size() - 1);
+  for (std::size_t round = 0; round < 8; ++round) {
+    std::size_t n =
+        2 * Lexer::parallel_grain + rng() % (4 * Lexer::parallel_grain);
+    input_t in{};
+    for (std::size_t i = 0; i < n; ++i)
+      in.push_back(words[word(rng)]);
+    // Most "--" would put all of the input in hyphen mode early on.
+    for (auto &c : in)
+      if (c == "--" && rng() % 64)
+        c = "free";
+    switch (round % 4) {
+    case 1: // an error somewhere
+      in[rng() % n] = malformed[rng() % malformed.size()];
+      break;
+    case 2: // a value missing at the end
+      in.back() = "--profile";
+      break;
+    case 3: // no hyphen mode at all
+      std::ranges::replace(in, std::string{"--"}, std::string{"xy"});
+      break;
+    }
+
+    std::size_t off = round % 3;
+    auto expected = lex.try_tokenize(in, off);
+    for (std::size_t nthreads : {2, 3, 8})
+      if (++check;
+          !same(lex.try_tokenize_parallel(in, off, nthreads), expected))
+        return check;
+  }
+  return 0;
+}
+} // namespace
+
+int main() {
+  std::size_t check = 0;
+  std::mt19937 rng{42};
+
+  glex::lexer_t<std::vector> lex{};
+  populate(lex);
+  if (run(lex, rng, check))
+    return err(check);
+
+  glex::lexer_t<std::vector, glex::token_id_t> id_lex{};
+  populate(id_lex);
+  if (run(id_lex, rng, check))
+    return err(check);
+
+  glex::lexer_t<std::list> list_lex{};
+  populate(list_lex);
+  list_lex.abbreviations(true);
+  if (run(list_lex, rng, check))
+    return err(check);
+
+  // With 2 threads, the input is cut at its middle if it can be.
+  using input_t = glex::lexer_t<std::vector>::input_t;
+  const auto n = 4 * lex.parallel_grain;
+  const std::vector<std::vector<std::string>> middles = {
+      {"--", "-h"},          // the "--" token takes the next chunk
+      {"-p", "-p", "-h"},    // a value taking a value
+      {"-hp", "-h", "--"},   // a value then the hyphen mode
+      {"-p", "--", "-p"},    // a "--" value, then no hyphen mode
+      {"--files", "a", "b"}, // a single character free value fails
+  };
+  for (const auto &middle : middles) {
+    input_t in(n, "-h");
+    std::ranges::copy(middle, in.begin() + n / 2 - 1);
+    if (++check; !same(lex.try_tokenize_parallel(in, 0, 2),
+                       lex.try_tokenize(in)))
+      return err(check);
+  }
+
+  // Too small to be split.
+  const glex::lexer_t<std::vector>::input_t small = {"-p", "v", "--help"};
+  if (++check; !same(lex.try_tokenize_parallel(small, 0, 8),
+                     lex.try_tokenize(small)))
+    return err(check);
+}
@@ -0,0 +1,49 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that the glex::pmr tokens
+// take all their memory from the supplied resource. The default
+// resource is replaced by one that always fails to allocate.
+
+int main() {
+  using avt = glex::argument_t::value_t::type_t;
+  std::size_t check{0};
+
+  glex::lexer_t<std::pmr::vector, glex::pmr::token_t> lex{};
+  lex.add({.token = "a-long-help-token-name",
+           .verbose = "help",
+           .concise = 'h',
+           .value = {}});
+  lex.add({.token = "a-long-files-token-name",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+  const std::vector<std::string> in = {
+      "--help", "-hf", "a-long-first-value,a-long-second-value", "--",
+      "a-long-free-value-that-does-not-fit-in-sso"};
+
+  std::pmr::set_default_resource(std::pmr::null_memory_resource());
+  try {
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(),
+                                              std::pmr::null_memory_resource()};
+    auto tokens = lex.tokenize(in, 0, &arena);
+    if (++check; tokens.size() != 4 || tokens[2].values.size() != 2)
+      return err(check);
+    if (++check; tokens[0].id != "a-long-help-token-name" ||
+                 tokens[3].values.front() != std::string_view{in[4]})
+      return err(check);
+
+    auto stream = lex.stream(&arena);
+    std::size_t count = 0;
+    for (const auto &chunk : in)
+      stream.push(chunk, [&](glex::pmr::token_t &&) { ++count; });
+    stream.finish([&](glex::pmr::token_t &&) { ++count; });
+    if (++check; count != 4)
+      return err(check);
+  } catch (const std::exception &e) {
+    return err(check, std::string{"Unexpected exception: "} + e.what() +
+                          "\nFailed check ");
+  }
+}
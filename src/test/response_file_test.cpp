@@ -0,0 +1,84 @@
+#include "test_util.hpp"
+#include <filesystem>
+#include <fstream>
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, writes a few response files
+// to a temporary directory, and checks that @file chunks
+// are expanded, nested files are followed, and recursion
+// and unreadable files are reported.
+
+namespace {
+namespace fs = std::filesystem;
+using lexer_t = glex::lexer_t<std::vector>;
+
+void write(const fs::path &p, const std::string &content) {
+  std::ofstream{p} << content;
+}
+} // namespace
+
+int main() {
+  using avt = glex::argument_t::value_t::type_t;
+  using code = glex::lex_error::code_t;
+  std::size_t check{0};
+
+  auto dir = fs::temp_directory_path() / "glex-response-file-test";
+  fs::create_directories(dir);
+  auto at = [&](const char *name) { return "@" + (dir / name).string(); };
+
+  write(dir / "outer.rsp", "--help\n  -f 'a b',c\t" + at("inner.rsp") + "\n");
+  write(dir / "inner.rsp", "\"free \\\"quoted\\\"\" back\\ slash\n");
+  write(dir / "empty.rsp", "");
+  write(dir / "self.rsp", "--help " + at("loop.rsp"));
+  write(dir / "loop.rsp", at("self.rsp"));
+  write(dir / "novalue.rsp", "-f");
+
+  lexer_t lex{};
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+
+  // Disabled by default, @ chunks are free values.
+  auto r = lex.try_tokenize({at("outer.rsp")});
+  if (++check; !r || r->size() != 1 || r->front().values.front()[0] != '@')
+    return err(check);
+
+  lex.response_files(true);
+  r = lex.try_tokenize({"-h", at("outer.rsp"), at("empty.rsp"), "--", "@x"});
+  const std::vector<glex::token_t> expected = {
+      {.id = "help", .values = {}},
+      {.id = "help", .values = {}},
+      {.id = "file", .values = {"a b", "c"}},
+      {.id = "", .values = {"free \"quoted\""}},
+      {.id = "", .values = {"back slash"}},
+      {.id = "", .values = {"@x"}},
+  };
+  if (++check; !r || r->size() != expected.size())
+    return err(check);
+  for (std::size_t i = 0; i < expected.size(); ++i)
+    if (++check;
+        (*r)[i].id != expected[i].id || (*r)[i].values != expected[i].values)
+      return err(check);
+
+  struct failure_t {
+    lexer_t::input_t input;
+    glex::lex_error expected;
+  };
+  const std::vector<failure_t> failures = {
+      {{"-h", at("missing.rsp")}, {code::bad_response, 1, 0}},
+      {{at("self.rsp")}, {code::recursive_response, 0, 0}},
+      {{"-h", at("novalue.rsp")}, {code::missing_value, 1, 0}},
+  };
+  for (const auto &f : failures) {
+    auto r = lex.try_tokenize(f.input);
+    if (++check; r || r.error().code != f.expected.code ||
+                 r.error().index != f.expected.index ||
+                 r.error().offset != f.expected.offset)
+      return err(check);
+  }
+
+  fs::remove_all(dir);
+}
@@ -0,0 +1,138 @@
+#include "test_util.hpp"
+#include <atomic>
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+#include <thread>
+
+// This test takes no input, and checks that try_tokenize_shared()
+// returns the cached result of an input tokenized before,
+// evicting the least recently used inputs, that the cache is emptied
+// when the database changes, that it holds under many threads,
+// and that it never holds more results than its capacity.
+
+namespace {
+constexpr std::size_t nthreads = 8;
+constexpr std::size_t iterations = 2000;
+
+using avt = glex::argument_t::value_t::type_t;
+using lexer_t = glex::lexer_t<std::vector>;
+
+// Whether the shared result r is the same as that of try_tokenize().
+bool same(const lexer_t::shared_result_t &r, const lexer_t::result_t &e) {
+  if (!r || !e)
+    return !r && !e && r.error().code == e.error().code &&
+           r.error().index == e.error().index;
+  return equal(**r, *e);
+}
+} // namespace
+
+int main() {
+  lexer_t lex{};
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+
+  const std::vector<lexer_t::input_t> inputs = {
+      {"--help", "-p/path", "-f=f1,f2"},
+      {"--files", "a,b", "free"},
+      {"--profile"}, // fails, a value is required
+      {"-x"},        // fails, not in the database
+      {"a", "--help"},
+  };
+
+  std::size_t check = 0;
+  // Without a cache every call tokenizes.
+  auto r1 = lex.try_tokenize_shared(inputs[0]);
+  auto r2 = lex.try_tokenize_shared(inputs[0]);
+  if (++check; !same(r1, lex.try_tokenize(inputs[0])) || *r1 == *r2 ||
+               lex.cache_stats().hits || lex.cache_stats().misses)
+    return err(check);
+
+  lex.cache(2);
+  r1 = lex.try_tokenize_shared(inputs[0]);
+  r2 = lex.try_tokenize_shared(inputs[0]);
+  if (++check; !r1 || !r2 || *r1 != *r2)
+    return err(check);
+  // Errors are cached too.
+  if (++check; !same(lex.try_tokenize_shared(inputs[2]),
+                     lex.try_tokenize(inputs[2])) ||
+               !same(lex.try_tokenize_shared(inputs[2]),
+                     lex.try_tokenize(inputs[2])))
+    return err(check);
+  auto s = lex.cache_stats();
+  if (++check; s.hits != 2 || s.misses != 2 || s.size != 2)
+    return err(check);
+
+  // The offset is part of the input.
+  auto tail = lex.try_tokenize_shared(inputs[4], 1);
+  if (++check; !same(tail, lex.try_tokenize(inputs[4], 1)) ||
+               !same(lex.try_tokenize_shared(inputs[4]),
+                     lex.try_tokenize(inputs[4])))
+    return err(check);
+
+  // inputs[4] from 0 and 1 are the 2 most recently used.
+  lex.try_tokenize_shared(inputs[4], 1);
+  lex.try_tokenize_shared(inputs[0]);
+  s = lex.cache_stats();
+  if (++check; s.hits != 3 || s.misses != 5 || s.size != 2)
+    return err(check);
+  lex.try_tokenize_shared(inputs[4], 1);
+  if (++check; lex.cache_stats().hits != 4)
+    return err(check);
+
+  // The cache is emptied once the database changes.
+  lex.add({.token = "extr", .verbose = "extract", .concise = 'e', .value = {}});
+  auto r3 = lex.try_tokenize_shared(inputs[0]);
+  if (++check; lex.cache_stats().size != 1 || *r3 == *r1)
+    return err(check);
+
+  // From argv, with the program name skipped.
+  char prog[] = "prog", help[] = "--help", extract[] = "-e";
+  char *argv[] = {prog, help, extract};
+  auto a1 = lex.try_tokenize_shared(3, argv);
+  auto a2 = lex.try_tokenize_shared(3, argv);
+  if (++check; !a1 || !a2 || *a1 != *a2 || (*a1)->size() != 2)
+    return err(check);
+
+  // A copy has the capacity, but none of the results.
+  auto copy = lex;
+  if (++check; copy.cache() != 2 || copy.cache_stats().size != 0)
+    return err(check);
+
+  // Under many threads, with more inputs than the cache holds.
+  std::vector<lexer_t::result_t> expected{};
+  for (const auto &in : inputs)
+    expected.push_back(lex.try_tokenize(in));
+  for (std::size_t capacity : {3, 1000}) {
+    lex.cache(capacity);
+    std::atomic<std::size_t> mismatches{0};
+    std::vector<std::thread> threads{};
+    for (std::size_t t = 0; t < nthreads; ++t)
+      threads.emplace_back([&, t] {
+        for (std::size_t i = 0; i < iterations; ++i) {
+          auto idx = (i + t) % inputs.size();
+          if (!same(lex.try_tokenize_shared(inputs[idx]), expected[idx]))
+            ++mismatches;
+        }
+      });
+    for (auto &t : threads)
+      t.join();
+    s = lex.cache_stats();
+    if (++check; mismatches || s.hits + s.misses != nthreads * iterations ||
+                 s.size > capacity)
+      return err(check);
+  }
+
+  // A capacity not divisible among the shards is still exact.
+  lex.cache(257);
+  for (int i = 0; i < 5000; ++i)
+    lex.try_tokenize_shared({"free" + std::to_string(i)});
+  if (++check; lex.cache_stats().size != 257)
+    return err(check);
+}
@@ -0,0 +1,11 @@
+#include <gnu-lexer/static_database.hpp>
+
+// This file must not compile: the database contains
+// two arguments with the same long name.
+
+constexpr auto db = glex::make_database({
+    {.token = "help", .verbose = "help", .concise = 'h', .value = {}},
+    {.token = "hint", .verbose = "help", .concise = 'i', .value = {}},
+});
+
+int main() { return db.size(); }
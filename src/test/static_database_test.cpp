@@ -0,0 +1,74 @@
+#include "test_util.hpp"
+#include <gnu-lexer/static_database.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that a static_database_t
+// resolves every argument and tokenizes like the runtime database.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+
+constexpr auto db = glex::make_database({
+    {.token = "help", .verbose = "help", .concise = 'h', .value = {}},
+    {.token = "extr", .verbose = "extract", .concise = 'e', .value = {}},
+    {.token = "anlz", .verbose = "analyze", .concise = 'a', .value = {}},
+    {.token = "prof",
+     .verbose = "profile",
+     .concise = 'p',
+     .value = {.type = avt::single}},
+    {.token = "file",
+     .verbose = "files",
+     .concise = 'f',
+     .value = {.type = avt::multi, .delimiter = ','}},
+    {.token = "verb", .verbose = "verbose", .concise = 0, .value = {}},
+});
+
+static_assert(db.size() == 6);
+static_assert(db.verbose("help") == 1);
+static_assert(db.argument(db.verbose("profile")).token == "prof");
+static_assert(db.argument(db.verbose("verbose")).token == "verb");
+static_assert(db.verbose("prof") == glex::no_arg);
+static_assert(db.verbose("") == glex::no_arg);
+static_assert(db.argument(db.concise('f')).verbose == "files");
+static_assert(db.concise('v') == glex::no_arg);
+static_assert(db.concise(0) == glex::no_arg);
+} // namespace
+
+int main() {
+  std::size_t check{0};
+
+  glex::lexer_t<std::vector> rlex{};
+  for (const auto &a : db)
+    rlex.add({.token = std::string{a.token},
+              .verbose = std::string{a.verbose},
+              .concise = a.concise,
+              .value = a.value});
+  glex::lexer_t<std::vector, glex::token_t, decltype(db)> slex{db};
+
+  for (std::size_t i = 0; i < db.size(); ++i) {
+    auto &a = *(db.begin() + i);
+    if (++check; &db.argument(db.verbose(a.verbose)) != &a)
+      return err(check);
+  }
+
+  std::vector<glex::lexer_t<std::vector>::input_t> inputs = {
+      {"--help", "-eap/path/to/prof", "-f=f1,f2,f3", "--", "--val"},
+      {"--verbose", "--files", "a,b,", "-hf", "c", "free"},
+      {"--profile=x", "-ahe", "-p", "y", "--analyze"},
+  };
+  for (const auto &in : inputs)
+    if (++check; !equal(rlex.tokenize(in), slex.tokenize(in)))
+      return err(check);
+
+  for (const auto &in : std::vector<glex::lexer_t<std::vector>::input_t>{
+           {"--missing"}, {"-x"}, {"--files"}}) {
+    bool thrown = false;
+    try {
+      slex.tokenize(in);
+    } catch (const std::exception &) {
+      thrown = true;
+    }
+    if (++check; !thrown)
+      return err(check);
+  }
+}
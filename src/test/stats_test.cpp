@@ -0,0 +1,146 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, and checks what a lexer built with
+// GLEX_STATS counts: the calls, chunks, lookups, values and errors,
+// and a latency per call, and that the histogram buckets cover
+// every latency.
+
+static_assert(GLEX_STATS, "Built against gnu-lexer-stats, which counts.");
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using code = glex::lex_error::code_t;
+using lexer_t = glex::lexer_t<std::vector>;
+
+std::size_t check_histogram(std::size_t &check) {
+  using h = glex::latency_histogram_t;
+  // One check per loop, their number would wrap the exit status.
+  ++check;
+  for (std::uint64_t v = 0; v < 1 << 20; v = v * 5 / 4 + 1) {
+    auto b = h::bucket(v);
+    // In its bucket, whose bounds are within 12.5% of each other.
+    if (b >= h::nbuckets || h::lowest(b) > v || h::highest(b) < v ||
+        h::highest(b) - h::lowest(b) > h::lowest(b) / 8)
+      return check;
+  }
+  if (++check; h::bucket(UINT64_MAX) != h::nbuckets - 1 ||
+               h::highest(h::nbuckets - 1) != UINT64_MAX)
+    return check;
+  ++check;
+  for (std::size_t b = 1; b < h::nbuckets; ++b)
+    if (h::lowest(b) != h::highest(b - 1) + 1)
+      return check;
+
+  h hist{};
+  hist.counts[h::bucket(100)] = 90;
+  hist.counts[h::bucket(5000)] = 10;
+  if (++check; hist.total() != 100 || hist.percentile(0.5) != 103 ||
+               hist.percentile(0.9) != 103 ||
+               hist.percentile(0.91) != h::highest(h::bucket(5000)))
+    return check;
+  return 0;
+}
+} // namespace
+
+int main() {
+  std::size_t check = 0;
+  if (check_histogram(check))
+    return err(check);
+
+  lexer_t lex{};
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "extr", .verbose = "extract", .concise = 'e', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+
+  const lexer_t::input_t in = {"--help", "-ep", "/p", "-f=a,b,c", "--",
+                               "--val"};
+  std::uint64_t bytes = 0;
+  for (const auto &c : in)
+    bytes += c.size();
+
+  if (++check; !lex.try_tokenize(in))
+    return err(check);
+  auto s = lex.stats().counts;
+  if (++check; s.calls != 1 || s.bytes != bytes)
+    return err(check);
+  if (++check; s.value_chunks != 1 || s.arglist_chunks != 2 ||
+               s.longarg_chunks != 1 || s.freearg_chunks != 2)
+    return err(check);
+  if (++check; s.verbose_lookups != 1 || s.verbose_misses != 0 ||
+               s.concise_lookups != 3 || s.concise_misses != 0)
+    return err(check);
+  if (++check; s.values_split != 3)
+    return err(check);
+  for (auto e : s.errors)
+    if (++check; e)
+      return err(check);
+
+  // Every entry point counts its calls and errors.
+  lex.reset_stats();
+  lexer_t::container_t out{};
+  if (++check; lex.try_tokenize({"-x"}) || lex.try_tokenize({"--nope"}) ||
+               lex.try_tokenize_into(out, {"--profile"}) ||
+               !lex.try_tokenize_into(out, {"-h"}))
+    return err(check);
+  const std::vector<lexer_t::input_t> batch(10, {"--files", "a,b"});
+  lex.tokenize_batch(batch, 2);
+  s = lex.stats().counts;
+  if (++check; s.calls != 14 || s.errors_of(code::unknown_concise) != 1 ||
+               s.errors_of(code::unknown_verbose) != 1 ||
+               s.errors_of(code::missing_value) != 1)
+    return err(check);
+  if (++check; s.concise_misses != 1 || s.verbose_misses != 1 ||
+               s.verbose_lookups != 12 || s.values_split != 20)
+    return err(check);
+  if (++check; lex.stats().latency.total() != 14)
+    return err(check);
+
+  // A stream counts its chunks and errors, but is not a call.
+  lex.reset_stats();
+  auto st = lex.stream();
+  std::size_t ntokens = 0;
+  st.push("-hp", [&](auto &&) { ++ntokens; });
+  st.push("x", [&](auto &&) { ++ntokens; });
+  st.finish([&](auto &&) { ++ntokens; });
+  s = lex.stats().counts;
+  if (++check; ntokens != 2 || s.calls != 0 || s.arglist_chunks != 1 ||
+               s.value_chunks != 1 || s.bytes != 4)
+    return err(check);
+  try {
+    auto bad = lex.stream();
+    bad.push("--help=x", [](auto &&) {});
+    return err(++check);
+  } catch (const std::runtime_error &) {
+  }
+  if (++check; lex.stats().counts.errors_of(code::unexpected_value) != 1)
+    return err(check);
+
+  // A copy counts on its own.
+  auto copy = lex;
+  if (++check; copy.stats().counts.bytes != 0 ||
+               lex.stats().counts.bytes == 0)
+    return err(check);
+  lex.reset_stats();
+  if (++check; lex.stats().counts.bytes != 0 ||
+               lex.stats().latency.total() != 0)
+    return err(check);
+
+  // Lazy tokens count the values they will split into.
+  glex::lexer_t<std::vector, glex::lazy_token_t> lazy{};
+  lazy.add({.token = "file",
+            .verbose = "files",
+            .concise = 'f',
+            .value = {.type = avt::multi, .delimiter = ','}});
+  if (++check; !lazy.try_tokenize({"-f=a,b,c", "--files", "d,"}) ||
+               lazy.stats().counts.values_split != 4)
+    return err(check);
+}
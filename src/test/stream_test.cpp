@@ -0,0 +1,77 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that a stream_t emits every
+// token as soon as it is complete, and produces the same tokens
+// as tokenize() for the same input.
+
+namespace {
+using lexer_t = glex::lexer_t<std::vector>;
+} // namespace
+
+int main() {
+  using avt = glex::argument_t::value_t::type_t;
+  std::size_t check{0};
+
+  lexer_t lex{};
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "extr", .verbose = "extract", .concise = 'e', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "file",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+
+  lexer_t::container_t got{};
+  const auto collect = [&](glex::token_t &&t) { got.push_back(std::move(t)); };
+
+  auto stream = lex.stream();
+  stream.push("--help", collect);
+  if (++check; got.size() != 1 || got[0].id != "help")
+    return err(check);
+  stream.push("-ep", collect);
+  if (++check; got.size() != 2 || got[1].id != "extr")
+    return err(check);
+  stream.push("/path", collect);
+  if (++check; got.size() != 3 || got[2].values.front() != "/path")
+    return err(check);
+  stream.push("--", collect);
+  if (++check; got.size() != 3)
+    return err(check);
+  stream.push("--val", collect);
+  if (++check; got.size() != 4 || got[3].values.front() != "--val")
+    return err(check);
+  stream.finish(collect);
+  if (++check; got.size() != 4)
+    return err(check);
+
+  const std::vector<lexer_t::input_t> inputs = {
+      {"--help", "-ep/path/to/prof", "-f=f1,f2,f3", "--", "--val"},
+      {"--files", "a,b,", "-hf", "c", "free"},
+      {"--profile=x", "-he", "-p", "y", "--extract", "--"},
+  };
+  for (const auto &in : inputs) {
+    got.clear();
+    auto s = lex.stream();
+    for (const auto &chunk : in)
+      s.push(chunk, collect);
+    s.finish(collect);
+    if (++check; !equal(got, lex.tokenize(in)))
+      return err(check);
+  }
+
+  bool thrown = false;
+  try {
+    auto s = lex.stream();
+    s.push("--profile", collect);
+    s.finish(collect);
+  } catch (const std::exception &) {
+    thrown = true;
+  }
+  if (++check; !thrown)
+    return err(check);
+}
@@ -1,4 +1,5 @@
 #include <gnu-lexer/lexer.hpp>
+#include <ranges>
 
 /* This test takes the following input:
  * <def>... ; <arg>... ; <out>...
@@ -181,7 +182,7 @@ std::vector<glex::token_t> process(const T &outs, const std::string &delim2) {
 int main(int argc, char **argv) {
   const std::string delim{";"};
   const std::string delim2{":"};
-  int begin = 1;
+  int begin = 1, inpbeg = 0;
 
   if (!verify(delim, argc, argv))
     return 1;
@@ -190,7 +191,8 @@ int main(int argc, char **argv) {
   std::vector<glex::token_t> expected{};
   try {
     defs = glex::read(argc, argv, delim, begin);
-    inpt = glex::read(argc, argv, delim, ++begin);
+    inpbeg = ++begin;
+    inpt = glex::read(argc, argv, delim, begin);
     expected = process(glex::read(argv, argc - (begin + 1), begin + 1), delim2);
   } catch (const std::exception &e) {
     std::cerr << "ERR: parsing input failed: " << e.what() << std::endl;
@@ -198,13 +200,17 @@ int main(int argc, char **argv) {
   }
 
   using llexer_t = glex::lexer_t<std::list>;
+  using vlexer_t = glex::lexer_t<std::vector, glex::token_view_t>;
   std::vector<glex::argument_t> args{};
   llexer_t lexer{};
+  vlexer_t vlexer{};
   lexer.debug(true);
 
   try {
-    for (auto &&def : defs)
+    for (auto &&def : defs) {
       append(def, delim2, lexer);
+      append(def, delim2, vlexer);
+    }
   } catch (const std::exception &e) {
     std::cerr << "ERR: creating database failed: " << e.what() << std::endl;
     return 1;
@@ -221,4 +227,17 @@ int main(int argc, char **argv) {
   if (!verify(tokens, expected))
     return 1;
   print(tokens, "TOKENS: ");
+
+  // The view lexer must produce the same tokens straight from argv.
+  typename vlexer_t::container_t views{};
+  try {
+    views = vlexer.tokenize(begin, argv, inpbeg);
+  } catch (const std::exception &e) {
+    std::cerr << "ERR: view tokenization failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (!verify(views, expected))
+    return 1;
+  print(views, "VIEWS: ");
 }
@@ -0,0 +1,26 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// Helpers shared by the tests.
+
+// Reports the failed check c, returned as the exit status.
+inline std::size_t err(const std::size_t c,
+                       const std::string &msg = "Failed check ") {
+  std::cerr << msg << c << std::endl;
+  return c;
+}
+
+/* Whether the tokens in a and b have the same ids, values and scalars,
+ * whatever their containers, and whether they own their strings.
+ */
+template <typename T, typename U> bool equal(const T &a, const U &b) {
+  return std::ranges::equal(a, b, [](const auto &x, const auto &y) {
+    if constexpr (requires { x.scalars, y.scalars; })
+      if (!std::ranges::equal(x.scalars, y.scalars))
+        return false;
+    return x.id == y.id && std::ranges::equal(x.values, y.values);
+  });
+}
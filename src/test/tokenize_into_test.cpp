@@ -0,0 +1,161 @@
+#include "test_util.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+#include <list>
+#include <new>
+
+// This test takes no input, and checks that tokenize_into() gives
+// the same tokens as tokenize(), and that once warmed up it makes
+// no allocation, counted by the global operator new and by a
+// memory resource for the glex::pmr tokens.
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+} // namespace
+
+void *operator new(std::size_t n) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc{};
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using input_t = std::vector<std::string>;
+
+struct counting_resource_t : std::pmr::memory_resource {
+  std::size_t count{0};
+
+  void *do_allocate(std::size_t n, std::size_t align) override {
+    ++count;
+    return std::pmr::new_delete_resource()->allocate(n, align);
+  }
+  void do_deallocate(void *p, std::size_t n, std::size_t align) override {
+    std::pmr::new_delete_resource()->deallocate(p, n, align);
+  }
+  bool do_is_equal(const memory_resource &o) const noexcept override {
+    return this == &o;
+  }
+};
+
+template <typename Lexer> void populate(Lexer &lex) {
+  lex.add({.token = "a-long-help-token-name",
+           .verbose = "help",
+           .concise = 'h',
+           .value = {}});
+  lex.add({.token = "a-long-profile-token-name",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+  lex.add({.token = "a-long-files-token-name",
+           .verbose = "files",
+           .concise = 'f',
+           .value = {.type = avt::multi, .delimiter = ','}});
+}
+
+const input_t large = {
+    "--help",
+    "-hf",
+    "a-long-first-value,a-long-second-value,a-long-third-value",
+    "--profile=/a/long/path/to/the/profile",
+    "--",
+    "a-long-free-value-that-does-not-fit-in-sso"};
+const input_t small = {"-p", "/a/long/path/to/another/profile",
+                       "--files=a-long-single-value,"};
+const input_t missing = {"--profile"};
+const input_t unknown = {"-h", "--nope"};
+
+/* Checks every result, and that calls whose result fits
+ * in the previous one do not allocate.
+ */
+template <typename Lexer, typename F>
+std::size_t run(const Lexer &lex, typename Lexer::container_t &out, F count,
+                std::size_t &check) {
+  for (const auto *in : {&large, &small, &large}) {
+    lex.tokenize_into(out, *in);
+    if (++check; !equal(out, lex.tokenize(*in)))
+      return check;
+  }
+
+  for (const auto *in : {&large, &small, &missing}) {
+    std::ignore = lex.try_tokenize_into(out, *in);
+    auto before = count();
+    for (int i = 0; i < 100; ++i)
+      std::ignore = lex.try_tokenize_into(out, *in);
+    if (++check; count() != before)
+      return check;
+  }
+  lex.tokenize_into(out, large);
+  if (++check; !equal(out, lex.tokenize(large)))
+    return check;
+
+  // The tokens before the error are kept.
+  using code = glex::lex_error::code_t;
+  auto r = lex.try_tokenize_into(out, unknown);
+  if (++check; r || r.error().code != code::unknown_verbose)
+    return check;
+  if (++check; out.size() != 1 || !glex::detail::has_id(out.begin()->id))
+    return check;
+  return 0;
+}
+} // namespace
+
+int main() {
+  std::size_t check{0};
+  const auto global = [] { return allocations.load(); };
+
+  try {
+    glex::lexer_t<std::vector> lex{};
+    populate(lex);
+    glex::lexer_t<std::vector>::container_t out{};
+    if (auto c = run(lex, out, global, check))
+      return err(c);
+
+    glex::lexer_t<std::vector, glex::token_id_t> ilex{};
+    populate(ilex);
+    glex::lexer_t<std::vector, glex::token_id_t>::container_t ids{};
+    if (auto c = run(ilex, ids, global, check))
+      return err(c);
+
+    glex::lexer_t<std::vector, glex::token_view_t> vlex{};
+    populate(vlex);
+    glex::lexer_t<std::vector, glex::token_view_t>::container_t views{};
+    if (auto c = run(vlex, views, global, check))
+      return err(c);
+
+    counting_resource_t resource{};
+    glex::lexer_t<std::pmr::vector, glex::pmr::token_t> plex{};
+    populate(plex);
+    std::pmr::vector<glex::pmr::token_t> pmr{&resource};
+    if (auto c = run(plex, pmr, [&] { return resource.count; }, check))
+      return err(c);
+    if (++check; !resource.count)
+      return err(check);
+
+    // Other containers give the same tokens, though moving a deque
+    // allocates, and lists keep no spares.
+    glex::lexer_t<std::deque> dlex{};
+    populate(dlex);
+    glex::lexer_t<std::deque>::container_t deque{};
+    glex::lexer_t<std::list> llex{};
+    populate(llex);
+    glex::lexer_t<std::list>::container_t list{};
+    for (const auto *in : {&large, &small, &large}) {
+      dlex.tokenize_into(deque, *in);
+      if (++check; !equal(deque, dlex.tokenize(*in)))
+        return err(check);
+      llex.tokenize_into(list, *in);
+      if (++check; !equal(list, llex.tokenize(*in)))
+        return err(check);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return err(++check, "Unexpected exception at check ");
+  }
+}
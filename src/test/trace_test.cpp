@@ -0,0 +1,65 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that a trace sink
+// receives the expected events in order, and none once removed.
+
+namespace {
+using kind = glex::trace_event_t::kind_t;
+
+struct record_t : glex::trace_sink_t {
+  std::vector<glex::trace_event_t> events{};
+  void event(const glex::trace_event_t &e) override { events.push_back(e); }
+};
+} // namespace
+
+int main() {
+  using avt = glex::argument_t::value_t::type_t;
+  std::size_t check{0};
+
+  glex::lexer_t<std::vector> lex{};
+  auto help = lex.add(
+      {.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  auto prof = lex.add({.token = "prof",
+                       .verbose = "profile",
+                       .concise = 'p',
+                       .value = {.type = avt::single}});
+
+  record_t sink{};
+  lex.trace(&sink);
+  lex.tokenize({"-hp", "/path", "--help", "free"});
+
+  const std::vector<glex::trace_event_t> expected = {
+      {kind::chunk, 0, "-hp"},
+      {kind::arglist, 0, "-hp"},
+      {kind::matched, 0, "-hp", help},
+      {kind::matched, 0, "-hp", prof},
+      {kind::chunk, 1, "/path"},
+      {kind::value, 1, "/path"},
+      {kind::chunk, 2, "--help"},
+      {kind::longarg, 2, "--help"},
+      {kind::matched, 2, "--help", help},
+      {kind::chunk, 3, "free"},
+      {kind::freearg, 3, "free"},
+  };
+  if (++check; sink.events.size() != expected.size())
+    return err(check);
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    const auto &a = sink.events[i];
+    const auto &b = expected[i];
+    if (++check; a.kind != b.kind || a.index != b.index ||
+                 a.chunk != b.chunk || a.arg != b.arg)
+      return err(check);
+  }
+
+  sink.events.clear();
+  lex.trace(nullptr);
+  lex.tokenize({"-h"});
+  if (++check; !sink.events.empty() || lex.debug())
+    return err(check);
+
+  lex.debug(true);
+  if (++check; lex.trace() != &glex::stdout_trace())
+    return err(check);
+}
@@ -0,0 +1,69 @@
+#include "test_util.hpp"
+#include <gnu-lexer/lexer.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that try_tokenize
+// reports every malformed input with the right code,
+// chunk index and offset, without throwing.
+
+namespace {
+using lexer_t = glex::lexer_t<std::vector>;
+} // namespace
+
+int main() {
+  using avt = glex::argument_t::value_t::type_t;
+  using code = glex::lex_error::code_t;
+  std::size_t check{0};
+
+  lexer_t lex{};
+  lex.add({.token = "help", .verbose = "help", .concise = 'h', .value = {}});
+  lex.add({.token = "prof",
+           .verbose = "profile",
+           .concise = 'p',
+           .value = {.type = avt::single}});
+
+  struct failure_t {
+    lexer_t::input_t input;
+    glex::lex_error expected;
+  };
+  const std::vector<failure_t> failures = {
+      {{"-h", "x"}, {code::short_chunk, 1, 0}},
+      {{"-hp="}, {code::empty_value, 0, 4}},
+      {{"-h1"}, {code::bad_arglist_char, 0, 2}},
+      {{"-hx"}, {code::unknown_concise, 0, 2}},
+      {{"--1help"}, {code::bad_verbose, 0, 2}},
+      {{"-h", "--nope=1"}, {code::unknown_verbose, 1, 2}},
+      {{"--help=1"}, {code::unexpected_value, 0, 2}},
+      {{"free", "-hp"}, {code::missing_value, 1, 2}},
+  };
+
+  try {
+    for (const auto &f : failures) {
+      auto r = lex.try_tokenize(f.input);
+      if (++check; r)
+        return err(check);
+      const auto &e = r.error();
+      if (++check; e.code != f.expected.code || e.index != f.expected.index ||
+                   e.offset != f.expected.offset)
+        return err(check);
+      if (++check; e.message(f.input[e.index]).empty())
+        return err(check);
+    }
+
+    auto r = lex.try_tokenize({"-hp", "/path", "--", "-x"});
+    if (++check; !r || r->size() != 3 || r->at(1).values.front() != "/path")
+      return err(check);
+  } catch (const std::exception &e) {
+    return err(check, std::string{"Unexpected exception: "} + e.what() +
+                          "\nFailed check ");
+  }
+
+  std::string what{};
+  try {
+    lex.tokenize({"-h", "--nope=1"});
+  } catch (const std::exception &e) {
+    what = e.what();
+  }
+  if (++check; what.find("'nope'") == std::string::npos)
+    return err(check);
+}
@@ -0,0 +1,131 @@
+#include "test_util.hpp"
+#include <gnu-lexer/static_database.hpp>
+#include <iostream>
+
+// This test takes no input, and checks that the values of arguments
+// declaring an element type are decoded into the tokens' scalars,
+// and that a bad value is reported at its position.
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+using elt = glex::argument_t::value_t::element_t;
+using code = glex::lex_error::code_t;
+
+template <typename Lexer> void populate(Lexer &lex) {
+  lex.add({.token = "nodes",
+           .verbose = "nodes",
+           .concise = 'n',
+           .value = {.type = avt::multi,
+                     .delimiter = ',',
+                     .element = elt::uint64}});
+  lex.add({.token = "offset",
+           .verbose = "offset",
+           .concise = 'o',
+           .value = {.type = avt::single, .element = elt::int64}});
+  lex.add({.token = "ratio",
+           .verbose = "ratio",
+           .concise = 'r',
+           .value = {.type = avt::single, .element = elt::real}});
+  lex.add({.token = "flags",
+           .verbose = "flags",
+           .concise = 'f',
+           .value = {.type = avt::multi,
+                     .delimiter = ':',
+                     .element = elt::boolean}});
+  lex.add({.token = "name",
+           .verbose = "name",
+           .concise = 'm',
+           .value = {.type = avt::single}});
+}
+
+template <typename Lexer>
+std::size_t run(const Lexer &lex, std::size_t &check) {
+  const typename Lexer::input_t in = {
+      "--nodes=1,2,18446744073709551615,", "-o", "-42", "-r0.5",
+      "--flags", "yes:off:1",              "-mx"};
+  auto r = lex.try_tokenize(in);
+  if (++check; !r || r->size() != 5)
+    return check;
+
+  const auto &t = *r;
+  using v = std::vector<glex::scalar_t>;
+  if (++check; t[0].scalars != v{1ull, 2ull, 18446744073709551615ull} ||
+               !t[0].values.empty())
+    return check;
+  if (++check; t[1].scalars != v{std::int64_t{-42}})
+    return check;
+  if (++check; t[2].scalars != v{0.5})
+    return check;
+  if (++check; t[3].scalars != v{true, false, true})
+    return check;
+  if (++check; !t[4].scalars.empty() || t[4].values.front() != "x")
+    return check;
+
+  struct failure_t {
+    typename Lexer::input_t input;
+    glex::lex_error expected;
+    std::string_view value;
+  };
+  const std::vector<failure_t> failures = {
+      {{"--nodes=1,x,3"}, {code::bad_value, 0, 10}, "'x'"},
+      {{"-n", "1,,3"}, {code::bad_value, 1, 2}, "''"},
+      {{"-n1,-2"}, {code::bad_value, 0, 4}, "'-2'"},
+      {{"-o", "9223372036854775808"}, {code::bad_value, 1, 0}, ""},
+      {{"--offset=12a"}, {code::bad_value, 0, 9}, "'12a'"},
+      {{"-r", "half"}, {code::bad_value, 1, 0}, "'half'"},
+      {{"--flags=yes:maybe"}, {code::bad_value, 0, 12}, "'maybe'"},
+  };
+  for (const auto &f : failures) {
+    auto e = lex.try_tokenize(f.input);
+    if (++check; e)
+      return check;
+    if (++check; e.error().code != f.expected.code ||
+                 e.error().index != f.expected.index ||
+                 e.error().offset != f.expected.offset)
+      return check;
+    auto msg = e.error().message(f.input[e.error().index]);
+    if (++check; msg.find(f.value) == std::string::npos)
+      return check;
+  }
+
+  // Reused tokens drop the scalars of the previous call.
+  typename Lexer::container_t out{};
+  lex.tokenize_into(out, in);
+  const typename Lexer::input_t other = {"-n", "7", "-m", "y"};
+  lex.tokenize_into(out, other);
+  if (++check; out.size() != 2 || out[0].scalars != v{7ull} ||
+               !out[1].scalars.empty())
+    return check;
+  return 0;
+}
+} // namespace
+
+int main() {
+  std::size_t check{0};
+  try {
+    glex::lexer_t<std::vector> lex{};
+    populate(lex);
+    if (auto c = run(lex, check))
+      return err(c);
+
+    glex::lexer_t<std::vector, glex::token_view_t> vlex{};
+    populate(vlex);
+    if (auto c = run(vlex, check))
+      return err(c);
+
+    constexpr auto db = glex::make_database({
+        {.token = "port",
+         .verbose = "port",
+         .concise = 'p',
+         .value = {.type = avt::single, .element = elt::uint64}},
+    });
+    glex::lexer_t<std::vector, glex::token_t, decltype(db)> slex{db};
+    auto t = slex.tokenize({"-p8080"});
+    if (++check; t.size() != 1 || std::get<std::uint64_t>(t[0].scalars[0]) !=
+                                      8080)
+      return err(check);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return err(++check, "Unexpected exception at check ");
+  }
+}
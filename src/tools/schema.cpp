@@ -0,0 +1,111 @@
+#include <fstream>
+#include <gnu-lexer/packed_database.hpp>
+#include <iostream>
+
+/* Packs a schema into the image loaded by packed_database_t::load().
+ *
+ * ./glex-schema <definitions> <output>
+ *
+ * The definitions file holds one argument per line, in the form
+ * used by test-lexer, optionally followed by the element type:
+ *  <id>:<long>:<short>:<none|single|multi>:<vdelim>[:<element>]
+ * where <short> and <vdelim> may be empty or 0 for none, and <element>
+ * is one of string (the default), int64, uint64, real or boolean.
+ * Empty lines and lines starting with # are ignored.
+ * The arguments get their ids in the order of the lines.
+ */
+
+namespace {
+using avt = glex::argument_t::value_t::type_t;
+
+bool parse(std::string_view line, glex::argument_t &arg) {
+  std::string_view fields[4];
+  for (auto &f : fields) {
+    auto end = line.find(':');
+    if (end == std::string_view::npos)
+      return false;
+    f = line.substr(0, end);
+    line.remove_prefix(end + 1);
+  }
+  // The delimiter may be a ':' itself, e.g. "::int64" or ":".
+  std::string_view element{"string"};
+  if (line.size() > 1 && line[1] == ':') {
+    element = line.substr(2);
+    line = line.substr(0, 1);
+  } else if (line.size() > 1 && line[0] == ':') {
+    element = line.substr(1);
+    line = {};
+  }
+  if (fields[2].size() > 1 || line.size() > 1)
+    return false;
+
+  arg.token = fields[0];
+  arg.verbose = fields[1];
+  // As in test-lexer, a 0 stands for none.
+  const auto single = [](std::string_view f) {
+    return f.empty() || f == "0" ? char{0} : f.front();
+  };
+  arg.concise = single(fields[2]);
+  arg.value.delimiter = single(line);
+
+  using elt = glex::argument_t::value_t::element_t;
+  if (element == "string")
+    arg.value.element = elt::string;
+  else if (element == "int64")
+    arg.value.element = elt::int64;
+  else if (element == "uint64")
+    arg.value.element = elt::uint64;
+  else if (element == "real")
+    arg.value.element = elt::real;
+  else if (element == "boolean")
+    arg.value.element = elt::boolean;
+  else
+    return false;
+  if (fields[3] == "none")
+    arg.value.type = avt::none;
+  else if (fields[3] == "single")
+    arg.value.type = avt::single;
+  else if (fields[3] == "multi")
+    arg.value.type = avt::multi;
+  else
+    return false;
+  return true;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <definitions> <output>"
+              << std::endl;
+    return 1;
+  }
+
+  std::ifstream in{argv[1]};
+  if (!in) {
+    std::cerr << "Cannot read " << argv[1] << std::endl;
+    return 1;
+  }
+
+  glex::database_t db{};
+  std::string line{};
+  for (std::size_t n = 1; std::getline(in, line); ++n) {
+    if (line.empty() || line.starts_with('#'))
+      continue;
+    glex::argument_t arg{};
+    try {
+      if (!parse(line, arg))
+        throw std::runtime_error{"The definition is malformed!"};
+      db.add(std::move(arg));
+    } catch (const std::exception &e) {
+      std::cerr << argv[1] << ":" << n << ": " << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  try {
+    glex::packed_database_t{db}.save(argv[2]);
+  } catch (const std::exception &e) {
+    std::cerr << argv[2] << ": " << e.what() << std::endl;
+    return 1;
+  }
+}